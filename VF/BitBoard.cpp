@@ -0,0 +1,119 @@
+#include "BitBoard.h"
+
+#include <bit>
+
+namespace VF
+{
+	BitBoard::BitBoard()
+		: m_Planes {}, m_ColumnMask(0), m_RowMask(0), m_Columns(0), m_Rows(0)
+	{
+	}
+
+	BitBoard::BitBoard(unsigned int rows, unsigned int columns)
+		: BitBoard()
+	{
+		if (!Fits(rows, columns))
+			return;
+
+		m_Columns = columns;
+		m_Rows = rows;
+
+		m_ColumnMask = (rows == 64) ? ~0ULL : ((1ULL << rows) - 1);
+		for (unsigned int u = 0; u < columns; u++)
+			m_RowMask |= 1ULL << (u * rows);
+	}
+
+	bool BitBoard::Fits(unsigned int rows, unsigned int columns)
+	{
+		return rows && columns && rows <= MAX_FIELDS && columns <= MAX_FIELDS && rows * columns <= MAX_FIELDS;
+	}
+
+	unsigned int BitBoard::GetColumnCount() const
+	{
+		return m_Columns;
+	}
+
+	unsigned int BitBoard::GetRowCount() const
+	{
+		return m_Rows;
+	}
+
+	void BitBoard::Load(const unsigned char* memos)
+	{
+		for (unsigned int p = 0; p < PLANE_COUNT; p++)
+			m_Planes[p] = 0;
+
+		for (unsigned int i = 0; i < (unsigned int)m_Columns * m_Rows; i++)
+		{
+			for (unsigned int p = 0; p < PLANE_COUNT; p++)
+				m_Planes[p] |= (uint64_t)((memos[i] >> p) & 1) << i;
+		}
+	}
+
+	void BitBoard::Store(unsigned char* memos) const
+	{
+		for (unsigned int i = 0; i < (unsigned int)m_Columns * m_Rows; i++)
+			memos[i] = GetMemo(i);
+	}
+
+	unsigned char BitBoard::GetMemo(unsigned int field) const
+	{
+		unsigned char memo = 0;
+		for (unsigned int p = 0; p < PLANE_COUNT; p++)
+			memo |= ((m_Planes[p] >> field) & 1) << p;
+		return memo;
+	}
+
+	void BitBoard::SetMemo(unsigned int field, unsigned char memo)
+	{
+		uint64_t bit = 1ULL << field;
+		for (unsigned int p = 0; p < PLANE_COUNT; p++)
+			m_Planes[p] = (m_Planes[p] & ~bit) | ((uint64_t)((memo >> p) & 1) << field);
+	}
+
+	uint64_t BitBoard::GetPlane(PLANE plane) const
+	{
+		return m_Planes[plane];
+	}
+
+	uint64_t BitBoard::GetLineMask(unsigned int index, bool isColumn) const
+	{
+		return isColumn ? (m_ColumnMask << (index * m_Rows)) : (m_RowMask << index);
+	}
+
+	BitBoard::LineCounts BitBoard::GetLineCounts(unsigned int index, bool isColumn) const
+	{
+		uint64_t line = GetLineMask(index, isColumn);
+		uint64_t conf = m_Planes[PLANE_CONF] & line;
+		uint64_t unconf = ~m_Planes[PLANE_CONF] & line;
+
+		LineCounts counts;
+		counts.confFieldCount = std::popcount(conf);
+		counts.confPointCount =
+			std::popcount(m_Planes[PLANE_1] & conf) +
+			std::popcount(m_Planes[PLANE_2] & conf) * 2 +
+			std::popcount(m_Planes[PLANE_3] & conf) * 3;
+		counts.confVoltCount = std::popcount(m_Planes[PLANE_VOLT] & conf);
+		counts.poss1Count = std::popcount(m_Planes[PLANE_1] & unconf);
+		counts.poss2Count = std::popcount(m_Planes[PLANE_2] & unconf);
+		counts.poss3Count = std::popcount(m_Planes[PLANE_3] & unconf);
+		counts.possVoltCount = std::popcount(m_Planes[PLANE_VOLT] & unconf);
+		return counts;
+	}
+
+	uint64_t BitBoard::ConfirmSingles()
+	{
+		uint64_t p1 = m_Planes[PLANE_1];
+		uint64_t p2 = m_Planes[PLANE_2];
+		uint64_t p3 = m_Planes[PLANE_3];
+		uint64_t pV = m_Planes[PLANE_VOLT];
+
+		//	A field has exactly one type left if it has any type left, but no pair of types.
+		uint64_t any = p1 | p2 | p3 | pV;
+		uint64_t pairs = (p1 & (p2 | p3 | pV)) | (p2 & (p3 | pV)) | (p3 & pV);
+
+		uint64_t singles = any & ~pairs & ~m_Planes[PLANE_CONF];
+		m_Planes[PLANE_CONF] |= singles;
+		return singles;
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+
+namespace VF
+{
+	//	Board state held as five bitplanes, one machine word per memo type plus one for confirmed fields.
+	//	Bit (column * rows + row) of every plane belongs to a field, matching the column-major layout of the memo matrices,
+	//	and plane p holds bit p of every memo (see Solver::MEMO_TYPE). Only boards with up to 64 fields fit.
+	class BitBoard
+	{
+	public:
+		enum PLANE : unsigned char
+		{
+			PLANE_1,		//	Fields that could be a 1
+			PLANE_2,		//	Fields that could be a 2
+			PLANE_3,		//	Fields that could be a 3
+			PLANE_VOLT,		//	Fields that could be a volt
+			PLANE_CONF,		//	Fields that are confirmed
+			PLANE_COUNT
+		};
+
+		struct LineCounts
+		{
+			unsigned int confFieldCount;	//	Count of confirmed fields
+			unsigned int confPointCount;	//	Sum of the points of all confirmed fields
+			unsigned int confVoltCount;		//	Count of confirmed volts
+			unsigned int poss1Count;		//	Count of unconfirmed fields that could be a 1
+			unsigned int poss2Count;		//	Count of unconfirmed fields that could be a 2
+			unsigned int poss3Count;		//	Count of unconfirmed fields that could be a 3
+			unsigned int possVoltCount;		//	Count of unconfirmed fields that could be a volt
+		};
+
+		static constexpr unsigned int MAX_FIELDS = 64;
+
+		BitBoard();
+
+		BitBoard(unsigned int rows, unsigned int columns);
+
+		//	Returns whether a board of these dimensions fits into the bitplanes.
+		static bool Fits(unsigned int rows, unsigned int columns);
+
+		unsigned int GetColumnCount() const;
+		unsigned int GetRowCount() const;
+
+		//	Loads all planes from a column-major matrix of memos.
+		void Load(const unsigned char* memos);
+
+		//	Stores all planes into a column-major matrix of memos.
+		void Store(unsigned char* memos) const;
+
+		unsigned char GetMemo(unsigned int field) const;
+
+		void SetMemo(unsigned int field, unsigned char memo);
+
+		uint64_t GetPlane(PLANE plane) const;
+
+		//	Gets the mask of all fields in a column or row.
+		uint64_t GetLineMask(unsigned int index, bool isColumn) const;
+
+		//	Counts confirmed and still possible types in a column or row with masked popcounts.
+		LineCounts GetLineCounts(unsigned int index, bool isColumn) const;
+
+		//	Confirms every unconfirmed field of the board with exactly one type left, returns the mask of the newly confirmed fields.
+		uint64_t ConfirmSingles();
+
+	private:
+		uint64_t m_Planes[PLANE_COUNT];
+
+		//	Mask of all fields in the first column/row, the other lines are shifted copies of it.
+		uint64_t m_ColumnMask;
+		uint64_t m_RowMask;
+
+		unsigned char m_Columns;
+		unsigned char m_Rows;
+	};
+}
@@ -0,0 +1,295 @@
+#include "BoardCounter.h"
+
+#include <bit>
+#include <utility>
+
+namespace VF
+{
+	static size_t HashState(uint64_t state)
+	{
+		state ^= state >> 33;
+		state *= 0xFF51AFD7ED558CCDULL;
+		state ^= state >> 33;
+		return (size_t)state;
+	}
+
+	void BoardCounter::StateMap::Clear(size_t expectedCount)
+	{
+		size_t capacity = 16;
+		while (capacity < expectedCount * 2)
+			capacity *= 2;
+
+		m_States.assign(capacity, 0);
+		m_Counts.assign(capacity, 0.0);
+		m_IsUsed.assign(capacity, 0);
+		m_Size = 0;
+	}
+
+	double& BoardCounter::StateMap::operator[](uint64_t state)
+	{
+		if ((m_Size + 1) * 2 > m_States.size())
+			Grow();
+
+		size_t mask = m_States.size() - 1;
+		for (size_t i = HashState(state) & mask;; i = (i + 1) & mask)
+		{
+			if (!m_IsUsed[i])
+			{
+				m_IsUsed[i] = 1;
+				m_States[i] = state;
+				m_Counts[i] = 0.0;
+				m_Size++;
+				return m_Counts[i];
+			}
+			if (m_States[i] == state)
+				return m_Counts[i];
+		}
+	}
+
+	double BoardCounter::StateMap::Get(uint64_t state) const
+	{
+		size_t mask = m_States.size() - 1;
+		for (size_t i = HashState(state) & mask;; i = (i + 1) & mask)
+		{
+			if (!m_IsUsed[i])
+				return 0.0;
+			if (m_States[i] == state)
+				return m_Counts[i];
+		}
+	}
+
+	void BoardCounter::StateMap::Grow()
+	{
+		std::vector<uint64_t> states;
+		std::vector<double> counts;
+		std::vector<unsigned char> isUsed;
+		states.swap(m_States);
+		counts.swap(m_Counts);
+		isUsed.swap(m_IsUsed);
+
+		Clear(states.size());
+		for (size_t i = 0; i < states.size(); i++)
+		{
+			if (isUsed[i])
+				(*this)[states[i]] = counts[i];
+		}
+	}
+
+	BoardCounter::BoardCounter(unsigned int rows, unsigned int columns)
+		: m_Columns(columns), m_Rows(rows),
+		m_uPoint(nullptr), m_vPoint(nullptr), m_uVolt(nullptr), m_vVolt(nullptr),
+		m_PointShift(rows), m_VoltShift(rows), m_PointMask(rows), m_VoltMask(rows), m_ThreeShift(0), m_ThreeDelta(0),
+		m_ValuesTemp(rows), m_ColumnAssignmentStart(columns + 1), m_Forward(columns + 1)
+	{
+	}
+
+	double BoardCounter::Count(const unsigned int* uPoint, const unsigned int* vPoint, const unsigned int* uVolt, const unsigned int* vVolt, const unsigned char* memos, double* fieldCounts,
+		const double* threeWeights)
+	{
+		m_uPoint = uPoint;
+		m_vPoint = vPoint;
+		m_uVolt = uVolt;
+		m_vVolt = vVolt;
+
+		if (fieldCounts)
+		{
+			for (unsigned int i = 0; i < m_Columns * m_Rows * VALUE_COUNT; i++)
+				fieldCounts[i] = 0.0;
+		}
+
+		if (!m_Columns || !m_Rows)
+			return 0.0;
+
+		//	1. Lay out the state: every row gets a field for its used points and one for its used volts,
+		//	wide enough that adding one more column never carries into the next field.
+		unsigned int shift = 0;
+		uint64_t finalState = 0;
+		for (unsigned int v = 0; v < m_Rows; v++)
+		{
+			unsigned int pointBits = std::bit_width(vPoint[v] + 3);
+			unsigned int voltBits = std::bit_width(vVolt[v] + 1);
+			if (shift + pointBits + voltBits > 64)
+				return -1.0;
+
+			m_PointShift[v] = shift;
+			m_PointMask[v] = (1ULL << pointBits) - 1;
+			shift += pointBits;
+
+			m_VoltShift[v] = shift;
+			m_VoltMask[v] = (1ULL << voltBits) - 1;
+			shift += voltBits;
+
+			finalState |= ((uint64_t)vPoint[v] << m_PointShift[v]) | ((uint64_t)vVolt[v] << m_VoltShift[v]);
+		}
+
+		//	The count of 3s goes on top, only the final states differ in it, since no row constrains it.
+		m_ThreeShift = shift;
+		m_ThreeDelta = 0;
+		if (threeWeights)
+		{
+			if (shift + std::bit_width(m_Rows * m_Columns) > 64)
+				return -1.0;
+			m_ThreeDelta = 1ULL << shift;
+		}
+
+		//	2. Enumerate the arrangements of every column that match its hints and memos.
+		m_Assignments.clear();
+		m_AssignmentValues.clear();
+		for (unsigned int u = 0; u < m_Columns; u++)
+		{
+			m_ColumnAssignmentStart[u] = m_Assignments.size();
+			EnumerateColumn(u, 0, 0, 0, 0, memos);
+			if (m_Assignments.size() == m_ColumnAssignmentStart[u])
+				return 0.0;
+		}
+		m_ColumnAssignmentStart[m_Columns] = m_Assignments.size();
+
+		//	3. Forward pass: count the partial boards leading to every state, dropping states the remaining columns can not complete.
+		m_Forward[0].Clear(1);
+		m_Forward[0][0] = 1.0;
+		for (unsigned int u = 0; u < m_Columns; u++)
+		{
+			const StateMap& layer = m_Forward[u];
+			StateMap& nextLayer = m_Forward[u + 1];
+			nextLayer.Clear(layer.m_Size);
+
+			for (size_t i = 0; i < layer.m_States.size(); i++)
+			{
+				if (!layer.m_IsUsed[i])
+					continue;
+
+				for (size_t a = m_ColumnAssignmentStart[u]; a < m_ColumnAssignmentStart[u + 1]; a++)
+				{
+					uint64_t state = layer.m_States[i] + m_Assignments[a].delta;
+					if (IsStateFeasible(state, m_Columns - u - 1))
+						nextLayer[state] += layer.m_Counts[i];
+				}
+			}
+		}
+
+		//	Every board ends in the final state, plus its count of 3s if those are weighted.
+		StateMap backward;
+		StateMap backwardNext;
+		double boardCount = 0.0;
+		if (!threeWeights)
+		{
+			boardCount = m_Forward[m_Columns].Get(finalState);
+			backwardNext.Clear(1);
+			backwardNext[finalState] = 1.0;
+		}
+		else
+		{
+			const StateMap& layer = m_Forward[m_Columns];
+			backwardNext.Clear(layer.m_Size);
+			for (size_t i = 0; i < layer.m_States.size(); i++)
+			{
+				if (!layer.m_IsUsed[i] || (layer.m_States[i] & (m_ThreeDelta - 1)) != finalState)
+					continue;
+
+				double weight = threeWeights[layer.m_States[i] >> m_ThreeShift];
+				if (weight == 0.0)
+					continue;
+
+				boardCount += layer.m_Counts[i] * weight;
+				backwardNext[layer.m_States[i]] = weight;
+			}
+		}
+
+		if (boardCount == 0.0 || !fieldCounts)
+			return boardCount;
+
+		//	4. Backward pass: count the (weighted) completions of every state reachable from the left, and weight every column assignment
+		//	by the count of partial boards on its left times the count of completions on its right.
+
+		std::vector<double> assignmentWeights;
+		for (int u = m_Columns - 1; u >= 0; u--)
+		{
+			const StateMap& layer = m_Forward[u];
+			size_t assignmentStart = m_ColumnAssignmentStart[u];
+			size_t assignmentCount = m_ColumnAssignmentStart[u + 1] - assignmentStart;
+
+			assignmentWeights.assign(assignmentCount, 0.0);
+			backward.Clear(layer.m_Size);
+
+			for (size_t i = 0; i < layer.m_States.size(); i++)
+			{
+				if (!layer.m_IsUsed[i])
+					continue;
+
+				double completions = 0.0;
+				for (size_t a = 0; a < assignmentCount; a++)
+				{
+					double count = backwardNext.Get(layer.m_States[i] + m_Assignments[assignmentStart + a].delta);
+					if (count == 0.0)
+						continue;
+
+					completions += count;
+					assignmentWeights[a] += layer.m_Counts[i] * count;
+				}
+
+				if (completions != 0.0)
+					backward[layer.m_States[i]] = completions;
+			}
+
+			for (size_t a = 0; a < assignmentCount; a++)
+			{
+				const VALUE* values = m_AssignmentValues.data() + m_Assignments[assignmentStart + a].first;
+				for (unsigned int v = 0; v < m_Rows; v++)
+					fieldCounts[(u * m_Rows + v) * VALUE_COUNT + values[v]] += assignmentWeights[a];
+			}
+
+			std::swap(backward, backwardNext);
+		}
+
+		return boardCount;
+	}
+
+	void BoardCounter::EnumerateColumn(unsigned int column, unsigned int row, unsigned int points, unsigned int volts, uint64_t delta, const unsigned char* memos)
+	{
+		//	Prune arrangements whose remaining fields can no longer reach the column hints.
+		if (points > m_uPoint[column] || volts > m_uVolt[column])
+			return;
+
+		unsigned int rowsLeft = m_Rows - row;
+		unsigned int voltsLeft = m_uVolt[column] - volts;
+		unsigned int pointsLeft = m_uPoint[column] - points;
+		if (voltsLeft > rowsLeft || pointsLeft < rowsLeft - voltsLeft || pointsLeft > (rowsLeft - voltsLeft) * 3)
+			return;
+
+		if (row == m_Rows)
+		{
+			m_Assignments.push_back(ColumnAssignment { delta, (unsigned int)m_AssignmentValues.size() });
+			m_AssignmentValues.insert(m_AssignmentValues.end(), m_ValuesTemp.begin(), m_ValuesTemp.end());
+			return;
+		}
+
+		//	Bit n of a memo allows value n, in the same order as Solver::MEMO_TYPE.
+		unsigned char memo = memos[column * m_Rows + row];
+		for (unsigned int value = 0; value < VALUE_COUNT; value++)
+		{
+			if (!(memo & (1 << value)))
+				continue;
+
+			m_ValuesTemp[row] = (VALUE)value;
+			EnumerateColumn(column, row + 1, points + VALUE_POINTS[value], volts + VALUE_VOLTS[value],
+				delta + ((uint64_t)VALUE_POINTS[value] << m_PointShift[row]) + ((uint64_t)VALUE_VOLTS[value] << m_VoltShift[row]) + (value == VALUE_3 ? m_ThreeDelta : 0), memos);
+		}
+	}
+
+	bool BoardCounter::IsStateFeasible(uint64_t state, unsigned int columnsLeft) const
+	{
+		for (unsigned int v = 0; v < m_Rows; v++)
+		{
+			unsigned int points = (state >> m_PointShift[v]) & m_PointMask[v];
+			unsigned int volts = (state >> m_VoltShift[v]) & m_VoltMask[v];
+			if (points > m_vPoint[v] || volts > m_vVolt[v])
+				return false;
+
+			unsigned int voltsLeft = m_vVolt[v] - volts;
+			unsigned int pointsLeft = m_vPoint[v] - points;
+			if (voltsLeft > columnsLeft || pointsLeft < columnsLeft - voltsLeft || pointsLeft > (columnsLeft - voltsLeft) * 3)
+				return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace VF
+{
+	//	Counts the full boards consistent with the hints and the memos of a board, without enumerating them.
+	//	The count is a dynamic program over the columns, whose state is the points and volts already used in every row.
+	class BoardCounter
+	{
+	public:
+		enum VALUE : unsigned char
+		{
+			VALUE_1,
+			VALUE_2,
+			VALUE_3,
+			VALUE_VOLT,
+			VALUE_COUNT
+		};
+
+		//	Points and volts per value.
+		static constexpr unsigned int VALUE_POINTS[VALUE_COUNT] = { 1, 2, 3, 0 };
+		static constexpr unsigned int VALUE_VOLTS[VALUE_COUNT] = { 0, 0, 0, 1 };
+
+		//	Whether a line that used points and volts so far can still reach its hints with fieldsLeft more fields.
+		static constexpr bool IsLineFeasible(unsigned int points, unsigned int volts, unsigned int pointHint, unsigned int voltHint, unsigned int fieldsLeft)
+		{
+			if (points > pointHint || volts > voltHint)
+				return false;
+
+			unsigned int voltsLeft = voltHint - volts;
+			unsigned int pointsLeft = pointHint - points;
+			return voltsLeft <= fieldsLeft && pointsLeft >= fieldsLeft - voltsLeft && pointsLeft <= (fieldsLeft - voltsLeft) * 3;
+		}
+
+		BoardCounter(unsigned int rows, unsigned int columns);
+
+		//	Counts the boards consistent with the hints and the column-major matrix of memos, every field may only be of a type set in its memo.
+		//	If fieldCounts is not null, it receives VALUE_COUNT counts per field in column-major order: the count of consistent boards in which the field is of that value.
+		//	Counts are exact as long as they stay below 2^53, which holds for every 5x5 board. Returns a negative count if the hints are too large for the state encoding.
+		//	If threeWeights is not null, it holds rows * columns + 1 weights indexed by the count of 3s on a board, and every board counts with the weight of its 3s
+		//	instead of 1, both in the result and in fieldCounts. The hints fix the count of volts and the sum of the values, so the 3s also fix the count of 2s.
+		double Count(const unsigned int* uPoint, const unsigned int* vPoint, const unsigned int* uVolt, const unsigned int* vVolt, const unsigned char* memos, double* fieldCounts,
+			const double* threeWeights);
+
+	private:
+		//	One arrangement of a column that matches the column hints and memos.
+		struct ColumnAssignment
+		{
+			uint64_t delta;			//	Points and volts added to every row, encoded like a state.
+			unsigned int first;		//	Index of the first value of this assignment in m_AssignmentValues.
+		};
+
+		//	Open-addressing map from an encoded state to the count of partial boards leading to it.
+		class StateMap
+		{
+		public:
+			void Clear(size_t expectedCount);
+			double& operator[](uint64_t state);
+			double Get(uint64_t state) const;
+
+			std::vector<uint64_t> m_States;
+			std::vector<double> m_Counts;
+			std::vector<unsigned char> m_IsUsed;
+			size_t m_Size = 0;
+
+		private:
+			void Grow();
+		};
+
+		void EnumerateColumn(unsigned int column, unsigned int row, unsigned int points, unsigned int volts, uint64_t delta, const unsigned char* memos);
+
+		//	Whether a state can still be completed by the remaining columns.
+		bool IsStateFeasible(uint64_t state, unsigned int columnsLeft) const;
+
+		unsigned int const m_Columns;
+		unsigned int const m_Rows;
+
+		const unsigned int* m_uPoint;
+		const unsigned int* m_vPoint;
+		const unsigned int* m_uVolt;
+		const unsigned int* m_vVolt;
+
+		//	Bit offsets of the used points and volts of every row in an encoded state.
+		std::vector<unsigned int> m_PointShift;
+		std::vector<unsigned int> m_VoltShift;
+		std::vector<uint64_t> m_PointMask;
+		std::vector<uint64_t> m_VoltMask;
+
+		//	Bit offset and increment of the count of 3s in an encoded state, the increment is 0 if the 3s are not counted.
+		unsigned int m_ThreeShift;
+		uint64_t m_ThreeDelta;
+
+		std::vector<ColumnAssignment> m_Assignments;
+		std::vector<VALUE> m_AssignmentValues;
+		std::vector<VALUE> m_ValuesTemp;
+
+		//	Per column: index of the first assignment in m_Assignments.
+		std::vector<size_t> m_ColumnAssignmentStart;
+
+		//	Per column boundary: states reachable from the left, with the count of partial boards.
+		std::vector<StateMap> m_Forward;
+	};
+}
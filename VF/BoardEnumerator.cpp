@@ -0,0 +1,240 @@
+#include "BoardEnumerator.h"
+
+#include <mutex>
+
+namespace VF
+{
+	//	Gets the memo bit of the only value the last field of a feasible line can take, with pointsLeft and voltsLeft still missing on it.
+	static unsigned char GetForcedMemo(unsigned int pointsLeft, unsigned int voltsLeft)
+	{
+		return voltsLeft ? (1 << BoardCounter::VALUE_VOLT) : (1 << (pointsLeft - 1));
+	}
+
+	BoardEnumerator::BoardEnumerator(unsigned int rows, unsigned int columns, unsigned int threadCount)
+		: m_Columns(columns), m_Rows(rows), m_WordCount((2 * rows * columns + 63) / 64),
+		m_Pool(threadCount ? threadCount : 1), m_Deques(m_Pool.GetWorkerCount()), m_States(m_Pool.GetWorkerCount()),
+		m_uPoint(nullptr), m_vPoint(nullptr), m_uVolt(nullptr), m_vVolt(nullptr), m_Memos(nullptr), m_Callback(nullptr),
+		m_PendingCount(0), m_QueuedCount(0), m_IdleCount(0), m_IsStopped(false)
+	{
+	}
+
+	unsigned int BoardEnumerator::GetWordCount() const
+	{
+		return m_WordCount;
+	}
+
+	BoardCounter::VALUE BoardEnumerator::GetValue(const uint64_t* board, unsigned int field)
+	{
+		return (BoardCounter::VALUE)((board[field / 32] >> (2 * (field % 32))) & 3);
+	}
+
+	unsigned long long BoardEnumerator::Enumerate(const unsigned int* uPoint, const unsigned int* vPoint, const unsigned int* uVolt, const unsigned int* vVolt, const unsigned char* memos, const Callback& callback)
+	{
+		if (m_Columns == 0 || m_Rows == 0)
+			return 0;
+
+		m_uPoint = uPoint;
+		m_vPoint = vPoint;
+		m_uVolt = uVolt;
+		m_vVolt = vVolt;
+		m_Memos = memos;
+		m_Callback = &callback;
+		m_IdleCount = 0;
+		m_IsStopped = false;
+
+		for (WorkerState& state : m_States)
+			state.boardCount = 0;
+
+		//	The whole tree is the first task, the other workers steal its subtrees as soon as the first row is assigned.
+		PushTask(0, Task { 0, std::vector<unsigned int>(m_Columns), std::vector<unsigned int>(m_Columns), std::vector<uint64_t>(m_WordCount) });
+		m_Pool.Run(m_Pool.GetWorkerCount(), [this](unsigned int, unsigned int worker) { Work(worker); });
+
+		//	A stopped enumeration leaves tasks behind.
+		for (TaskDeque& deque : m_Deques)
+			deque.tasks.clear();
+		m_PendingCount = 0;
+		m_QueuedCount = 0;
+
+		unsigned long long boardCount = 0;
+		for (const WorkerState& state : m_States)
+			boardCount += state.boardCount;
+		return boardCount;
+	}
+
+	void BoardEnumerator::Work(unsigned int worker)
+	{
+		WorkerState& state = m_States[worker];
+
+		bool isIdle = false;
+		while (!m_IsStopped.load(std::memory_order_relaxed))
+		{
+			Task task;
+			if (!TakeTask(worker, task))
+			{
+				if (m_PendingCount == 0)
+					break;
+
+				if (!isIdle)
+				{
+					isIdle = true;
+					m_IdleCount++;
+				}
+
+				//	A worker that pushes a task after this one went idle sees m_IdleCount and wakes it, see PushTask().
+				std::unique_lock<std::mutex> lock(m_IdleMutex);
+				m_IdleCondition.wait(lock, [this]() { return m_QueuedCount > 0 || m_PendingCount == 0 || m_IsStopped; });
+				continue;
+			}
+
+			if (isIdle)
+			{
+				isIdle = false;
+				m_IdleCount--;
+			}
+
+			state.columnPoints = std::move(task.columnPoints);
+			state.columnVolts = std::move(task.columnVolts);
+			state.board = std::move(task.board);
+			Search(state, worker, 0, task.row, 0, 0);
+
+			if (--m_PendingCount == 0)
+				WakeIdleWorkers();
+		}
+
+		if (isIdle)
+			m_IdleCount--;
+	}
+
+	bool BoardEnumerator::TakeTask(unsigned int worker, Task& task)
+	{
+		for (unsigned int i = 0; i < m_Deques.size(); i++)
+		{
+			TaskDeque& deque = m_Deques[(worker + i) % m_Deques.size()];
+			std::lock_guard<std::mutex> lock(deque.mutex);
+			if (deque.tasks.empty())
+				continue;
+
+			//	The own newest task is the smallest one and still warm in the cache, the oldest task of another worker is the largest one.
+			if (i == 0)
+			{
+				task = std::move(deque.tasks.back());
+				deque.tasks.pop_back();
+			}
+			else
+			{
+				task = std::move(deque.tasks.front());
+				deque.tasks.pop_front();
+			}
+			m_QueuedCount--;
+			return true;
+		}
+
+		return false;
+	}
+
+	void BoardEnumerator::PushTask(unsigned int worker, Task&& task)
+	{
+		m_PendingCount++;
+
+		{
+			std::lock_guard<std::mutex> lock(m_Deques[worker].mutex);
+			m_Deques[worker].tasks.push_back(std::move(task));
+			m_QueuedCount++;
+		}
+
+		//	Taking the mutex makes sure an idle worker either sees the task before it waits, or already waits and gets notified.
+		if (m_IdleCount > 0)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_IdleMutex);
+			}
+			m_IdleCondition.notify_one();
+		}
+	}
+
+	void BoardEnumerator::WakeIdleWorkers()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_IdleMutex);
+		}
+		m_IdleCondition.notify_all();
+	}
+
+	void BoardEnumerator::Search(WorkerState& state, unsigned int worker, unsigned int u, unsigned int v, unsigned int rowPoints, unsigned int rowVolts)
+	{
+		if (m_IsStopped.load(std::memory_order_relaxed))
+			return;
+
+		//	Row v is complete, the feasibility checks made sure it matches its hints.
+		if (u == m_Columns)
+		{
+			if (v + 1 == m_Rows)
+			{
+				state.boardCount++;
+				if (!(*m_Callback)(state.board.data(), worker))
+				{
+					m_IsStopped = true;
+					WakeIdleWorkers();
+				}
+				return;
+			}
+
+			//	Hand the rest of the subtree to the deque if another worker is waiting for work.
+			if (m_IdleCount.load(std::memory_order_relaxed) > 0)
+			{
+				bool isDequeEmpty;
+				{
+					std::lock_guard<std::mutex> lock(m_Deques[worker].mutex);
+					isDequeEmpty = m_Deques[worker].tasks.empty();
+				}
+
+				if (isDequeEmpty)
+				{
+					PushTask(worker, Task { v + 1, state.columnPoints, state.columnVolts, state.board });
+					return;
+				}
+			}
+
+			Search(state, worker, 0, v + 1, 0, 0);
+			return;
+		}
+
+		//	Once the field before the last one of a line is assigned, the value of the last field is forced, so its memo is checked right away.
+		bool isLastRowForced = v + 2 == m_Rows;
+		bool isLastColumnForced = u + 2 == m_Columns;
+
+		unsigned int field = u * m_Rows + v;
+		uint64_t& word = state.board[field / 32];
+		unsigned int shift = 2 * (field % 32);
+
+		//	Bit n of a memo allows value n, in the same order as Solver::MEMO_TYPE.
+		for (unsigned int value = 0; value < BoardCounter::VALUE_COUNT; value++)
+		{
+			if (!(m_Memos[field] & (1 << value)))
+				continue;
+
+			unsigned int points = BoardCounter::VALUE_POINTS[value];
+			unsigned int volts = BoardCounter::VALUE_VOLTS[value];
+			unsigned int columnPoints = state.columnPoints[u] + points;
+			unsigned int columnVolts = state.columnVolts[u] + volts;
+			if (!BoardCounter::IsLineFeasible(columnPoints, columnVolts, m_uPoint[u], m_uVolt[u], m_Rows - v - 1) ||
+				!BoardCounter::IsLineFeasible(rowPoints + points, rowVolts + volts, m_vPoint[v], m_vVolt[v], m_Columns - u - 1))
+				continue;
+
+			if (isLastRowForced && !(m_Memos[field + 1] & GetForcedMemo(m_uPoint[u] - columnPoints, m_uVolt[u] - columnVolts)))
+				continue;
+			if (isLastColumnForced && !(m_Memos[field + m_Rows] & GetForcedMemo(m_vPoint[v] - rowPoints - points, m_vVolt[v] - rowVolts - volts)))
+				continue;
+
+			state.columnPoints[u] = columnPoints;
+			state.columnVolts[u] = columnVolts;
+			word |= (uint64_t)value << shift;
+
+			Search(state, worker, u + 1, v, rowPoints + points, rowVolts + volts);
+
+			word &= ~(3ULL << shift);
+			state.columnPoints[u] = columnPoints - points;
+			state.columnVolts[u] = columnVolts - volts;
+		}
+	}
+}
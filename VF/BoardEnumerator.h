@@ -0,0 +1,115 @@
+#pragma once
+
+#include "BoardCounter.h"
+#include "WorkerPool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace VF
+{
+	//	Lists every full board consistent with the hints and the memos of a board, without collecting them.
+	//	The search is a depth-first search over the rows, field by field, that prunes every field whose value leaves its row or column without
+	//	a legal completion. Whenever a worker runs out of work, the others hand it the subtrees of their next row boundary: every worker
+	//	keeps a deque of subtrees, works on its newest one and steals the oldest one of another worker when its own deque is empty.
+	class BoardEnumerator
+	{
+	public:
+		//	Called for every consistent board, by the worker that found it and at the same time as for other boards, so it has to be thread-safe.
+		//	board holds GetWordCount() words with 2 bits per field in column-major order, a BoardCounter::VALUE each (see GetValue()).
+		//	Returning false stops the enumeration.
+		using Callback = std::function<bool(const uint64_t* board, unsigned int worker)>;
+
+		BoardEnumerator(unsigned int rows, unsigned int columns, unsigned int threadCount);
+
+		BoardEnumerator(const BoardEnumerator&) = delete;
+		BoardEnumerator& operator=(const BoardEnumerator&) = delete;
+
+		//	Gets the count of words of a packed board.
+		unsigned int GetWordCount() const;
+
+		//	Gets the value of a field of a packed board.
+		static BoardCounter::VALUE GetValue(const uint64_t* board, unsigned int field);
+
+		//	Calls callback for every board consistent with the hints and the column-major matrix of memos, every field may only be of a type set in its memo.
+		//	Returns the count of boards passed to callback, including the one that stopped the enumeration.
+		unsigned long long Enumerate(const unsigned int* uPoint, const unsigned int* vPoint, const unsigned int* uVolt, const unsigned int* vVolt, const unsigned char* memos, const Callback& callback);
+
+	private:
+		//	The subtree of the boards below a complete prefix of rows.
+		struct Task
+		{
+			unsigned int row;						//	First row that is not assigned yet
+			std::vector<unsigned int> columnPoints;	//	Points used by the assigned rows per column
+			std::vector<unsigned int> columnVolts;	//	Volts used by the assigned rows per column
+			std::vector<uint64_t> board;			//	Packed values of the assigned rows, the others are 0
+		};
+
+		struct TaskDeque
+		{
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		//	State of the depth-first search of one worker.
+		struct WorkerState
+		{
+			std::vector<unsigned int> columnPoints;
+			std::vector<unsigned int> columnVolts;
+			std::vector<uint64_t> board;
+			unsigned long long boardCount;
+		};
+
+		//	Takes and runs tasks until every task is done or the enumeration was stopped. Without a task, a worker sleeps until one is pushed.
+		void Work(unsigned int worker);
+
+		//	Takes the newest task of the own deque or the oldest one of another worker, returns false if there is none.
+		bool TakeTask(unsigned int worker, Task& task);
+
+		void PushTask(unsigned int worker, Task&& task);
+
+		//	Wakes the idle workers, after the enumeration was done or stopped.
+		void WakeIdleWorkers();
+
+		//	Assigns the field (column u, row v) and everything after it in row-major order, with the points and volts used in row v so far.
+		void Search(WorkerState& state, unsigned int worker, unsigned int u, unsigned int v, unsigned int rowPoints, unsigned int rowVolts);
+
+		unsigned int const m_Columns;
+		unsigned int const m_Rows;
+		unsigned int const m_WordCount;
+
+		WorkerPool m_Pool;
+
+		//	Per worker
+		std::vector<TaskDeque> m_Deques;
+		std::vector<WorkerState> m_States;
+
+		//	Input of the current Enumerate()
+		const unsigned int* m_uPoint;
+		const unsigned int* m_vPoint;
+		const unsigned int* m_uVolt;
+		const unsigned int* m_vVolt;
+		const unsigned char* m_Memos;
+		const Callback* m_Callback;
+
+		//	Count of tasks pushed but not finished, the enumeration is done once it drops to 0.
+		std::atomic<size_t> m_PendingCount;
+
+		//	Count of tasks in the deques, i.e. pushed but not taken yet.
+		std::atomic<size_t> m_QueuedCount;
+
+		//	Count of workers looking for a task, the others split off subtrees while it is not 0.
+		std::atomic<unsigned int> m_IdleCount;
+
+		//	Idle workers wait on it for m_QueuedCount, m_PendingCount or m_IsStopped to change.
+		std::mutex m_IdleMutex;
+		std::condition_variable m_IdleCondition;
+
+		std::atomic<bool> m_IsStopped;
+	};
+}
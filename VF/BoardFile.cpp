@@ -0,0 +1,137 @@
+#include "BoardFile.h"
+
+#include <cstring>
+#include <filesystem>
+
+namespace VF
+{
+	static constexpr char BOARD_FILE_MAGIC[4] = { 'V', 'F', 'B', 'R' };
+
+	static BoardFileHeader CreateHeader()
+	{
+		BoardFileHeader header {};
+		std::memcpy(header.magic, BOARD_FILE_MAGIC, sizeof(BOARD_FILE_MAGIC));
+		header.version = BoardFileHeader::VERSION;
+		header.recordSize = sizeof(BoardRecord);
+		return header;
+	}
+
+	static bool IsHeaderValid(const BoardFileHeader& header)
+	{
+		BoardFileHeader expected = CreateHeader();
+		return std::memcmp(&header, &expected, sizeof(header)) == 0;
+	}
+
+	BoardFileReader::BoardFileReader()
+		: m_Records(nullptr), m_RecordCount(0)
+	{
+	}
+
+	bool BoardFileReader::Open(const char* path)
+	{
+		Close();
+
+		if (!m_File.Open(path) || m_File.GetSize() < sizeof(BoardFileHeader) || !IsHeaderValid(*(const BoardFileHeader*)m_File.GetData()))
+		{
+			m_File.Close();
+			return false;
+		}
+
+		//	The mapping is page-aligned, so the records right after the header are aligned as well.
+		m_Records = (const BoardRecord*)(m_File.GetData() + sizeof(BoardFileHeader));
+		m_RecordCount = (m_File.GetSize() - sizeof(BoardFileHeader)) / sizeof(BoardRecord);
+		return true;
+	}
+
+	void BoardFileReader::Close()
+	{
+		m_File.Close();
+		m_Records = nullptr;
+		m_RecordCount = 0;
+	}
+
+	bool BoardFileReader::IsOpen() const
+	{
+		return m_File.IsOpen();
+	}
+
+	size_t BoardFileReader::GetRecordCount() const
+	{
+		return m_RecordCount;
+	}
+
+	const BoardRecord& BoardFileReader::GetRecord(size_t index) const
+	{
+		return m_Records[index];
+	}
+
+	const BoardRecord* BoardFileReader::begin() const
+	{
+		return m_Records;
+	}
+
+	const BoardRecord* BoardFileReader::end() const
+	{
+		return m_Records + m_RecordCount;
+	}
+
+	bool BoardFileWriter::Open(const char* path, bool isAppending)
+	{
+		Close();
+
+		//	Check the header of an existing file and cut off a record left incomplete by an interrupted writer.
+		std::error_code error;
+		uintmax_t size = std::filesystem::file_size(path, error);
+		bool isExisting = isAppending && !error && size > 0;
+		if (isExisting)
+		{
+			BoardFileHeader header {};
+			std::ifstream file(path, std::ios::binary);
+			if (!file.read((char*)&header, sizeof(header)) || !IsHeaderValid(header))
+				return false;
+			file.close();
+
+			std::filesystem::resize_file(path, size - (size - sizeof(BoardFileHeader)) % sizeof(BoardRecord), error);
+			if (error)
+				return false;
+		}
+
+		m_File.open(path, std::ios::binary | (isExisting ? std::ios::app : std::ios::trunc));
+		if (!isExisting)
+		{
+			BoardFileHeader header = CreateHeader();
+			m_File.write((const char*)&header, sizeof(header));
+		}
+
+		if (!m_File)
+		{
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	void BoardFileWriter::Close()
+	{
+		if (m_File.is_open())
+			m_File.close();
+		m_File.clear();
+	}
+
+	bool BoardFileWriter::IsOpen() const
+	{
+		return m_File.is_open();
+	}
+
+	bool BoardFileWriter::Write(const BoardRecord* records, size_t count)
+	{
+		m_File.write((const char*)records, (std::streamsize)(count * sizeof(BoardRecord)));
+		return (bool)m_File;
+	}
+
+	bool BoardFileWriter::Flush()
+	{
+		m_File.flush();
+		return (bool)m_File;
+	}
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <type_traits>
+
+namespace VF
+{
+	//	Fixed-width record of a board: its hints, its memos and which of them the user confirmed, i.e. everything needed to resume a session.
+	//	Every field has a fixed offset and the record is a multiple of 8 bytes, so records are read in place from a mapped file.
+	struct BoardRecord
+	{
+		//	Longest line and most fields of a board that fits into a record.
+		static constexpr unsigned int MAX_DIM = 16;
+		static constexpr unsigned int MAX_FIELDS = 64;
+
+		//	Whether a board of these dimensions fits into a record.
+		static constexpr bool Fits(unsigned int rows, unsigned int columns)
+		{
+			return rows && columns && rows <= MAX_DIM && columns <= MAX_DIM && rows * columns <= MAX_FIELDS;
+		}
+
+		enum RECORD_FLAG : uint8_t
+		{
+			RECORD_VALID = 0b01		//	The hints are legal, set by whoever solved the board.
+		};
+
+		uint8_t rows;
+		uint8_t columns;
+		uint8_t flags;
+		uint8_t reserved[5];
+
+		uint8_t uPoint[MAX_DIM];
+		uint8_t uVolt[MAX_DIM];
+		uint8_t vPoint[MAX_DIM];
+		uint8_t vVolt[MAX_DIM];
+
+		//	Bit n is set if field n (column-major) is user-confirmed.
+		uint64_t userConf;
+
+		//	Column-major matrix of the memos, see Solver::MEMO_TYPE. Only the first rows * columns are used.
+		uint8_t memos[MAX_FIELDS];
+	};
+
+	static_assert(sizeof(BoardRecord) == 144 && std::is_trivially_copyable_v<BoardRecord>, "The record layout is part of the file format");
+
+	//	A board file is a BoardFileHeader followed by BoardRecords, in the byte order of the machine. There is no record count, the size of the file tells it,
+	//	so records can be appended without touching the header.
+	struct BoardFileHeader
+	{
+		static constexpr unsigned int VERSION = 1;
+
+		char magic[4];			//	"VFBR"
+		uint32_t version;
+		uint32_t recordSize;	//	sizeof(BoardRecord)
+		uint32_t reserved;
+	};
+
+	static_assert(sizeof(BoardFileHeader) == 16, "Records have to stay aligned after the header");
+
+	//	Reads the records of a board file in place: the file is mapped into memory, and iterating over the records neither copies nor allocates.
+	class BoardFileReader
+	{
+	public:
+		BoardFileReader();
+
+		BoardFileReader(const BoardFileReader&) = delete;
+		BoardFileReader& operator=(const BoardFileReader&) = delete;
+
+		//	Maps a board file, returns false if it can not be mapped or its header does not match. A record cut off at the end is ignored.
+		bool Open(const char* path);
+
+		void Close();
+
+		bool IsOpen() const;
+
+		size_t GetRecordCount() const;
+
+		//	The records stay valid until the reader is closed.
+		const BoardRecord& GetRecord(size_t index) const;
+
+		const BoardRecord* begin() const;
+		const BoardRecord* end() const;
+
+	private:
+		MappedFile m_File;
+
+		const BoardRecord* m_Records;
+		size_t m_RecordCount;
+	};
+
+	//	Streams records to the end of a board file, through the buffer of the stream.
+	class BoardFileWriter
+	{
+	public:
+		//	Opens a board file for writing. If isAppending and the file is a board file already, new records go after its last complete record,
+		//	otherwise the file is replaced by an empty board file. Returns false if the file can not be opened or is not a board file of this version.
+		bool Open(const char* path, bool isAppending);
+
+		void Close();
+
+		bool IsOpen() const;
+
+		//	Appends records, returns false if the stream failed.
+		bool Write(const BoardRecord* records, size_t count);
+
+		//	Writes the buffered records to the file, returns false if the stream failed.
+		bool Flush();
+
+	private:
+		std::ofstream m_File;
+	};
+}
@@ -0,0 +1,257 @@
+#include "FixedSolver.h"
+
+#include "GameLevels.h"
+#include "LookupTable.h"
+
+#include <bit>
+
+namespace VF
+{
+	template <unsigned int Rows, unsigned int Columns>
+	FixedSolver<Rows, Columns>::FixedSolver()
+		: m_LineTable(LineTable::Get()), m_uPoint {}, m_vPoint {}, m_uVolt {}, m_vVolt {},
+		m_Memos {}, m_MemosTemp {}, m_UserConf {}, m_IsMemosStable(false),
+		m_LastUserColumn(-1), m_LastUserRow(-1), m_LastUserMemo(MEMO_ALL)
+	{
+		ResetMemos();
+	}
+
+	template <unsigned int Rows, unsigned int Columns>
+	unsigned char FixedSolver<Rows, Columns>::GetMemo(unsigned int column, unsigned int row) const
+	{
+		return m_Memos[column * Rows + row];
+	}
+
+	template <unsigned int Rows, unsigned int Columns>
+	unsigned char FixedSolver<Rows, Columns>::SetMemo(unsigned int column, unsigned int row, Solver::MEMO_TYPE memo)
+	{
+		unsigned int field = column * Rows + row;
+		m_Memos[field] = memo | Solver::MEMO_CONF;
+		m_UserConf[field] = true;
+
+		m_LastUserColumn = column;
+		m_LastUserRow = row;
+		m_LastUserMemo = memo;
+
+		SolveUntilStable();
+
+		return m_Memos[field];
+	}
+
+	template <unsigned int Rows, unsigned int Columns>
+	unsigned char FixedSolver<Rows, Columns>::UnsetMemo(unsigned int column, unsigned int row)
+	{
+		unsigned int field = column * Rows + row;
+		m_Memos[field] = MEMO_ALL;
+		m_UserConf[field] = false;
+
+		ResetMemos();
+		SolveUntilStable();
+
+		return m_Memos[field];
+	}
+
+	template <unsigned int Rows, unsigned int Columns>
+	bool FixedSolver<Rows, Columns>::IsMemoUserConfirmed(unsigned int column, unsigned int row) const
+	{
+		return m_UserConf[column * Rows + row];
+	}
+
+	template <unsigned int Rows, unsigned int Columns>
+	void FixedSolver<Rows, Columns>::ResetBoard()
+	{
+		m_UserConf.fill(false);
+
+		m_LastUserColumn = -1;
+		m_LastUserRow = -1;
+		m_LastUserMemo = MEMO_ALL;
+
+		ResetMemos();
+	}
+
+	template <unsigned int Rows, unsigned int Columns>
+	bool FixedSolver<Rows, Columns>::SetHints(const unsigned int* uPoint, const unsigned int* vPoint, const unsigned int* uVolt, const unsigned int* vVolt)
+	{
+		for (unsigned int u = 0; u < Columns; u++)
+		{
+			if (uPoint[u] + uVolt[u] < Rows || uPoint[u] > (Rows - uVolt[u]) * 3)
+				return false;
+		}
+		for (unsigned int v = 0; v < Rows; v++)
+		{
+			if (vPoint[v] + vVolt[v] < Columns || vPoint[v] > (Columns - vVolt[v]) * 3)
+				return false;
+		}
+
+		for (unsigned int u = 0; u < Columns; u++)
+		{
+			m_uPoint[u] = uPoint[u];
+			m_uVolt[u] = uVolt[u];
+		}
+		for (unsigned int v = 0; v < Rows; v++)
+		{
+			m_vPoint[v] = vPoint[v];
+			m_vVolt[v] = vVolt[v];
+		}
+
+		ResetMemos();
+		SolveUntilStable();
+
+		return true;
+	}
+
+	template <unsigned int Rows, unsigned int Columns>
+	void FixedSolver<Rows, Columns>::ResetMemos()
+	{
+		m_IsMemosStable = false;
+
+		for (unsigned int field = 0; field < FIELD_COUNT; field++)
+		{
+			if (!m_UserConf[field])
+				m_Memos[field] = MEMO_ALL;
+		}
+	}
+
+	template <unsigned int Rows, unsigned int Columns>
+	void FixedSolver<Rows, Columns>::SolveUntilStable()
+	{
+		bool isLastUserMemo = m_LastUserColumn < Columns && m_LastUserRow < Rows;
+
+		//	If the legal solution is stable, only the lines crossing the last user memo can change.
+		m_MemosTemp = m_Memos;
+		LineMask queue = m_IsMemosStable && isLastUserMemo ? GetFieldLines(m_LastUserColumn, m_LastUserRow) : ALL_LINES;
+
+		if (SolveQueued(queue))
+		{
+			m_Memos = m_MemosTemp;
+			m_IsMemosStable = true;
+			return;
+		}
+
+		//	A contradiction before even a single button was clicked means the board is not solvable.
+		if (!isLastUserMemo || m_LastUserMemo == Solver::MEMO_CONF)
+			return;
+
+		//	Reset the memos to what they were before, minus the contradictory option selected by the user. If that contradicts as well,
+		//	the memos stay as they were.
+		m_MemosTemp = m_Memos;
+		m_MemosTemp[m_LastUserColumn * Rows + m_LastUserRow] = MEMO_ALL ^ m_LastUserMemo;
+		m_UserConf[m_LastUserColumn * Rows + m_LastUserRow] = false;
+
+		queue = m_IsMemosStable ? GetFieldLines(m_LastUserColumn, m_LastUserRow) : ALL_LINES;
+		if (SolveQueued(queue))
+		{
+			m_Memos = m_MemosTemp;
+			m_IsMemosStable = true;
+		}
+	}
+
+	template <unsigned int Rows, unsigned int Columns>
+	bool FixedSolver<Rows, Columns>::SolveQueued(LineMask queue)
+	{
+		while (queue)
+		{
+			unsigned int line = std::countr_zero(queue);
+			queue &= queue - 1;
+
+			bool isLegal = line < Columns ? SolveLine<true>(line, queue) : SolveLine<false>(line - Columns, queue);
+			if (!isLegal)
+				return false;
+		}
+
+		return true;
+	}
+
+	template <unsigned int Rows, unsigned int Columns>
+	template <bool IsColumn>
+	bool FixedSolver<Rows, Columns>::SolveLine(unsigned int index, LineMask& queue)
+	{
+		//	The fields of a column are adjacent, the fields of a row are Rows apart.
+		constexpr unsigned int LENGTH = IsColumn ? Rows : Columns;
+		constexpr unsigned int STRIDE = IsColumn ? 1 : Rows;
+		unsigned char* line = m_MemosTemp.data() + (IsColumn ? index * Rows : index);
+
+		int missingPoints;
+		int missingVolts;
+		if constexpr (IsColumn)
+		{
+			missingPoints = m_uPoint[index];
+			missingVolts = m_uVolt[index];
+		}
+		else
+		{
+			missingPoints = m_vPoint[index];
+			missingVolts = m_vVolt[index];
+		}
+
+		//	1. Subtract the confirmed fields from the hints, and pack the memos of the unconfirmed ones like an assignment of the LineTable.
+		std::array<unsigned char, LENGTH> openFields;
+		unsigned int missingFields = 0;
+		uint32_t allowed = 0;
+		for (unsigned int i = 0; i < LENGTH; i++)
+		{
+			unsigned char memo = line[i * STRIDE];
+			if (memo & Solver::MEMO_CONF)
+			{
+				switch (memo & MEMO_ALL)
+				{
+				case Solver::MEMO_1:
+					missingPoints -= 1;
+					break;
+				case Solver::MEMO_2:
+					missingPoints -= 2;
+					break;
+				case Solver::MEMO_3:
+					missingPoints -= 3;
+					break;
+				case Solver::MEMO_VOLT:
+					missingVolts--;
+					break;
+				}
+			}
+			else
+			{
+				allowed |= (uint32_t)(memo & MEMO_ALL) << (4 * missingFields);
+				openFields[missingFields++] = i;
+			}
+		}
+
+		//	A line without unconfirmed fields can not change, but its confirmed fields still have to match the hints.
+		if (missingFields == 0)
+			return missingPoints == 0 && missingVolts == 0;
+
+		if (missingPoints < 0 ||
+			missingVolts < 0 ||
+			missingVolts > (int)missingFields ||
+			missingPoints > ((int)missingFields - missingVolts) * 3 ||
+			missingPoints < ((int)missingFields - missingVolts) * 1
+		)
+			return false;
+
+		//	2. Keep the types of every unconfirmed field that appear in some legal assignment.
+		uint32_t legal = m_LineTable.Solve(GetLookupSlot(missingFields, missingVolts, missingPoints), allowed);
+		if (!legal)
+			return false;
+
+		//	3. Narrow the fields, confirm those with one type left, and queue the lines crossing the changed ones.
+		for (unsigned int j = 0; j < missingFields; j++)
+		{
+			unsigned int i = openFields[j];
+			unsigned char memo = (legal >> (4 * j)) & MEMO_ALL;
+			if (std::has_single_bit(memo))
+				memo |= Solver::MEMO_CONF;
+
+			if (memo != line[i * STRIDE])
+			{
+				line[i * STRIDE] = memo;
+				queue |= IsColumn ? (LineMask(1) << (Columns + i)) : (LineMask(1) << i);
+			}
+		}
+
+		return true;
+	}
+
+	//	The board of the game, and the largest board whose lines all fit into the LineTable.
+	template class FixedSolver<GAME_ROWS, GAME_COLUMNS>;
+	template class FixedSolver<8, 8>;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "LineTable.h"
+#include "Solver.h"
+
+#include <array>
+#include <cstdint>
+
+namespace VF
+{
+	//	Solver for boards whose dimensions are known at compile time, with the same memos as Solver for the same hints and user actions.
+	//	The storage is inline, and every line loop has constant bounds and a constant stride, so the compiler unrolls the loops and folds the indexing.
+	//	Lines are solved against the packed assignments of the LineTable, so both dimensions are limited to LineTable::MAX_FIELDS.
+	//	Only the instantiations in FixedSolver.cpp exist, Solver stays the fallback for every other size.
+	template <unsigned int Rows, unsigned int Columns>
+	class FixedSolver
+	{
+		static_assert(Rows >= 1 && Columns >= 1 && Rows <= LineTable::MAX_FIELDS && Columns <= LineTable::MAX_FIELDS, "Lines have to fit into the LineTable");
+
+	public:
+		FixedSolver();
+
+		static constexpr unsigned int GetColumnCount() { return Columns; }
+		static constexpr unsigned int GetRowCount() { return Rows; }
+
+		//	Gets a memo.
+		unsigned char GetMemo(unsigned int column, unsigned int row) const;
+
+		//	Sets and confirms a memo, returns the new memo. Like Solver, a memo that contradicts the board is withdrawn again and excluded instead.
+		unsigned char SetMemo(unsigned int column, unsigned int row, Solver::MEMO_TYPE memo);
+
+		//	Unsets a memo and solves the board again, returns the new memo. A small board is always solved from scratch, there is no trail to roll back.
+		unsigned char UnsetMemo(unsigned int column, unsigned int row);
+
+		bool IsMemoUserConfirmed(unsigned int column, unsigned int row) const;
+
+		//	Resets all memos, including the user-confirmed ones, so the solver can be reused for a new board.
+		void ResetBoard();
+
+		//	Sets the hints on the sides of the board, returns whether the hints are legal.
+		bool SetHints(const unsigned int* uPoint, const unsigned int* vPoint, const unsigned int* uVolt, const unsigned int* vVolt);
+
+	private:
+		static constexpr unsigned int FIELD_COUNT = Rows * Columns;
+		static constexpr unsigned char MEMO_ALL = Solver::MEMO_1 | Solver::MEMO_2 | Solver::MEMO_3 | Solver::MEMO_VOLT;
+
+		//	Lines to solve as a bitmask: bit u is column u, bit Columns + v is row v.
+		using LineMask = uint32_t;
+		static constexpr LineMask ALL_LINES = (LineMask)((1ULL << (Columns + Rows)) - 1);
+
+		//	Gets the lines crossing a field.
+		static constexpr LineMask GetFieldLines(unsigned int column, unsigned int row) { return (LineMask(1) << column) | (LineMask(1) << (Columns + row)); }
+
+		//	Reset all memos that are not user-confirmed.
+		void ResetMemos();
+
+		//	Solves the queued lines from the current legal solution until no more changes are possible, withdrawing the last user memo on a contradiction.
+		void SolveUntilStable();
+
+		//	Solves lines of m_MemosTemp until none is queued, returns false on a contradiction.
+		bool SolveQueued(LineMask queue);
+
+		//	Solves a column/row of m_MemosTemp and adds the lines crossing its changed fields to queue, returns false on a contradiction.
+		template <bool IsColumn>
+		bool SolveLine(unsigned int index, LineMask& queue);
+
+		const LineTable& m_LineTable;
+
+		std::array<unsigned int, Columns> m_uPoint;
+		std::array<unsigned int, Rows> m_vPoint;
+		std::array<unsigned int, Columns> m_uVolt;
+		std::array<unsigned int, Rows> m_vVolt;
+
+		//	Column-major matrix of the memos of the playing field
+		std::array<unsigned char, FIELD_COUNT> m_Memos;
+
+		//	Column-major matrix of the memos during a solver loop
+		std::array<unsigned char, FIELD_COUNT> m_MemosTemp;
+
+		//	Column-major matrix showing which fields are user-confirmed and should not be reset by ResetMemos()
+		std::array<bool, FIELD_COUNT> m_UserConf;
+
+		//	Whether m_Memos is a stable solution, so that after a single change only the crossing lines have to be solved again.
+		bool m_IsMemosStable;
+
+		unsigned int m_LastUserColumn;
+		unsigned int m_LastUserRow;
+		unsigned char m_LastUserMemo;
+	};
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+namespace VF
+{
+	//	Dimensions of the board in HG/SS.
+	constexpr unsigned int GAME_ROWS = 5;
+	constexpr unsigned int GAME_COLUMNS = 5;
+
+	constexpr unsigned int LEVEL_COUNT = 8;
+	constexpr unsigned int LEVEL_CONFIG_COUNT = 5;
+
+	//	One of the board configurations the game picks from on a level, every other field is a 1.
+	struct LevelConfig
+	{
+		unsigned char twos;
+		unsigned char threes;
+		unsigned char volts;
+	};
+
+	//	Board configurations of HG/SS per level (index 0 is level 1), the game picks one of the five of the current level with equal chance.
+	constexpr LevelConfig LEVEL_CONFIGS[LEVEL_COUNT][LEVEL_CONFIG_COUNT] =
+	{
+		{ { 3, 1,  6 }, { 0, 3,  6 }, { 5, 0,  6 }, { 2, 2,  6 }, { 4, 1,  6 } },
+		{ { 1, 3,  7 }, { 6, 0,  7 }, { 3, 2,  7 }, { 0, 4,  7 }, { 5, 1,  7 } },
+		{ { 2, 3,  8 }, { 7, 0,  8 }, { 4, 2,  8 }, { 1, 4,  8 }, { 6, 1,  8 } },
+		{ { 3, 3,  8 }, { 0, 5,  8 }, { 8, 0, 10 }, { 5, 2, 10 }, { 2, 4, 10 } },
+		{ { 7, 1, 10 }, { 4, 3, 10 }, { 1, 5, 10 }, { 9, 0, 10 }, { 6, 2, 10 } },
+		{ { 3, 4, 10 }, { 0, 6, 10 }, { 8, 1, 10 }, { 5, 3, 10 }, { 2, 5, 10 } },
+		{ { 7, 2, 10 }, { 4, 4, 10 }, { 1, 6, 13 }, { 9, 1, 13 }, { 6, 3, 10 } },
+		{ { 0, 7, 10 }, { 8, 2, 10 }, { 5, 4, 10 }, { 2, 6, 10 }, { 7, 3, 10 } }
+	};
+
+	//	Coins paid out for clearing a board of a configuration, the product of all its values.
+	constexpr unsigned int GetLevelConfigCoins(const LevelConfig& config)
+	{
+		unsigned int coins = 1;
+		for (unsigned int i = 0; i < config.twos; i++)
+			coins *= 2;
+		for (unsigned int i = 0; i < config.threes; i++)
+			coins *= 3;
+		return coins;
+	}
+
+	//	Chance of one particular board of a configuration once the game picked it: the game places the values on random fields, so every arrangement
+	//	of the twos, threes and volts among the GAME_ROWS * GAME_COLUMNS fields is equally likely.
+	constexpr double GetLevelConfigBoardChance(const LevelConfig& config)
+	{
+		//	Arrangements = fields! / (twos! threes! volts! ones!), built up as a product of binomial coefficients.
+		const unsigned int counts[] = { config.twos, config.threes, config.volts };
+		double arrangements = 1.0;
+		unsigned int placed = 0;
+		for (unsigned int count : counts)
+		{
+			for (unsigned int i = 1; i <= count; i++)
+				arrangements = arrangements * (GAME_ROWS * GAME_COLUMNS - placed - count + i) / i;
+			placed += count;
+		}
+		return 1.0 / arrangements;
+	}
+
+	//	Precomputed GetLevelConfigBoardChance() of every entry of LEVEL_CONFIGS.
+	constexpr struct LevelConfigBoardChances
+	{
+		double chances[LEVEL_COUNT][LEVEL_CONFIG_COUNT];
+
+		constexpr LevelConfigBoardChances()
+			: chances {}
+		{
+			for (unsigned int level = 0; level < LEVEL_COUNT; level++)
+			{
+				for (unsigned int i = 0; i < LEVEL_CONFIG_COUNT; i++)
+					chances[level][i] = GetLevelConfigBoardChance(LEVEL_CONFIGS[level][i]);
+			}
+		}
+	} LEVEL_CONFIG_BOARD_CHANCES;
+}
@@ -0,0 +1,87 @@
+#include "LineCache.h"
+
+namespace VF
+{
+	LineCache::LineCache(unsigned int capacity)
+		: m_Stats {}
+	{
+		size_t size = 1;
+		while (size < capacity)
+			size *= 2;
+
+		m_Entries.resize(size);
+	}
+
+	bool LineCache::MakeKey(const unsigned char* possibilities, unsigned int fieldCount, unsigned int missingPoints, unsigned int missingVolts, Key& key)
+	{
+		if (fieldCount > MAX_FIELDS || missingVolts > 0xFF || missingPoints > 0xFFFFFF)
+			return false;
+
+		key.counts = 0;
+		for (unsigned int i = 0; i < fieldCount; i++)
+		{
+			unsigned int mask = possibilities[i] & 0x0F;
+			if (mask == 0)
+				return false;
+
+			//	A count of at most MAX_FIELDS fits the 4 bits of its mask, so this never carries.
+			key.counts += 1ULL << (4 * (mask - 1));
+		}
+		key.totals = (missingPoints << 8) | missingVolts;
+		return true;
+	}
+
+	bool LineCache::Find(const Key& key, const unsigned char* possibilitiesIn, unsigned int fieldCount, unsigned char* possibilitiesOut, bool& isLegal)
+	{
+		const Entry& entry = m_Entries[GetSlot(key)];
+		if (!entry.isUsed || entry.counts != key.counts || entry.totals != key.totals)
+		{
+			m_Stats.misses++;
+			return false;
+		}
+
+		m_Stats.hits++;
+
+		isLegal = entry.isLegal;
+		if (isLegal)
+		{
+			for (unsigned int i = 0; i < fieldCount; i++)
+				possibilitiesOut[i] = (entry.results >> (4 * (possibilitiesIn[i] & 0x0F))) & 0x0F;
+		}
+		return true;
+	}
+
+	void LineCache::Insert(const Key& key, const unsigned char* possibilitiesIn, unsigned int fieldCount, const unsigned char* possibilitiesOut, bool isLegal)
+	{
+		Entry& entry = m_Entries[GetSlot(key)];
+		entry.counts = key.counts;
+		entry.totals = key.totals;
+		entry.isUsed = 1;
+		entry.isLegal = isLegal;
+		entry.results = 0;
+		if (isLegal)
+		{
+			for (unsigned int i = 0; i < fieldCount; i++)
+				entry.results |= (uint64_t)(possibilitiesOut[i] & 0x0F) << (4 * (possibilitiesIn[i] & 0x0F));
+		}
+	}
+
+	LineCache::Stats LineCache::GetStats() const
+	{
+		return m_Stats;
+	}
+
+	void LineCache::ResetStats()
+	{
+		m_Stats = Stats {};
+	}
+
+	size_t LineCache::GetSlot(const Key& key) const
+	{
+		uint64_t hash = key.counts ^ ((uint64_t)key.totals * 0x9E3779B97F4A7C15ULL);
+		hash ^= hash >> 33;
+		hash *= 0xFF51AFD7ED558CCDULL;
+		hash ^= hash >> 33;
+		return (size_t)hash & (m_Entries.size() - 1);
+	}
+}
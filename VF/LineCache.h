@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace VF
+{
+	//	Bounded cache of solved column/row situations, keyed on the multiset of the candidate masks of the unconfirmed fields
+	//	together with the missing points and volts. The order of the fields does not matter: fields with the same candidates
+	//	always get the same result, so the key counts the fields per candidate mask (a counting sort of the line), and the result
+	//	holds the narrowed mask per candidate mask, which maps back onto the fields in any order.
+	class LineCache
+	{
+	public:
+		//	Lines with more unconfirmed fields than this are not cached.
+		static constexpr unsigned int MAX_FIELDS = 15;
+
+		struct Key
+		{
+			uint64_t counts;		//	4 bits per candidate mask 1 to 15: the count of fields with that mask
+			uint32_t totals;		//	missing points << 8 | missing volts
+		};
+
+		struct Stats
+		{
+			unsigned long long hits;
+			unsigned long long misses;
+		};
+
+		//	The capacity is rounded up to a power of two.
+		explicit LineCache(unsigned int capacity);
+
+		//	Builds the key of a line from the candidate masks of its unconfirmed fields, returns false if the line can not be cached.
+		static bool MakeKey(const unsigned char* possibilities, unsigned int fieldCount, unsigned int missingPoints, unsigned int missingVolts, Key& key);
+
+		//	Looks up a line, returns whether it was found. If it was, isLegal receives whether the line has any legal arrangement,
+		//	and if so, possibilitiesOut receives the narrowed mask of every field.
+		bool Find(const Key& key, const unsigned char* possibilitiesIn, unsigned int fieldCount, unsigned char* possibilitiesOut, bool& isLegal);
+
+		//	Stores the result of a line, replacing whichever line was stored in the same slot.
+		void Insert(const Key& key, const unsigned char* possibilitiesIn, unsigned int fieldCount, const unsigned char* possibilitiesOut, bool isLegal);
+
+		Stats GetStats() const;
+
+		void ResetStats();
+
+	private:
+		struct Entry
+		{
+			uint64_t counts;
+			uint32_t totals;
+			unsigned char isUsed;
+			unsigned char isLegal;
+			uint64_t results;		//	4 bits per candidate mask 0 to 15: the narrowed mask of the fields with that mask
+		};
+
+		size_t GetSlot(const Key& key) const;
+
+		std::vector<Entry> m_Entries;
+
+		Stats m_Stats;
+	};
+}
@@ -0,0 +1,164 @@
+#include "LineTable.h"
+
+#include "LookupTable.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define LINE_TABLE_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+//	MSVC allows AVX2 intrinsics in any function, GCC and Clang only in functions compiled for that target.
+#if defined(LINE_TABLE_AVX2) && defined(__GNUC__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+namespace VF
+{
+	//	Memo bit and points of the types, in the order in which assignments are enumerated: 1, 2, 3, volt.
+	static constexpr uint32_t TYPE_MEMOS[4] = { 0b0001, 0b0010, 0b0100, 0b1000 };
+	static constexpr unsigned int TYPE_POINTS[4] = { 1, 2, 3, 0 };
+
+	static uint32_t FilterScalar(const uint32_t* assignments, unsigned int count, uint32_t allowed)
+	{
+		uint32_t legal = 0;
+		uint32_t forbidden = ~allowed;
+		for (unsigned int i = 0; i < count; i++)
+		{
+			if (!(assignments[i] & forbidden))
+				legal |= assignments[i];
+		}
+		return legal;
+	}
+
+#ifdef LINE_TABLE_AVX2
+	//	Tests 8 assignments per step: assignments using a forbidden type compare unequal to 0 after masking and are cleared before ORing.
+	TARGET_AVX2 static uint32_t FilterAvx2(const uint32_t* assignments, unsigned int count, uint32_t allowed)
+	{
+		const __m256i forbidden = _mm256_set1_epi32((int)~allowed);
+		const __m256i zero = _mm256_setzero_si256();
+		__m256i legal = zero;
+
+		unsigned int i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i words = _mm256_loadu_si256((const __m256i*)(assignments + i));
+			__m256i fits = _mm256_cmpeq_epi32(_mm256_and_si256(words, forbidden), zero);
+			legal = _mm256_or_si256(legal, _mm256_and_si256(words, fits));
+		}
+
+		//	OR-reduce the 8 lanes.
+		__m128i half = _mm_or_si128(_mm256_castsi256_si128(legal), _mm256_extracti128_si256(legal, 1));
+		half = _mm_or_si128(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+		half = _mm_or_si128(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+
+		return (uint32_t)_mm_cvtsi128_si32(half) | FilterScalar(assignments + i, count - i, allowed);
+	}
+
+	static bool IsAvx2Supported()
+	{
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+
+		//	The OS has to save the AVX registers (OSXSAVE set and XCR0 enabling the SSE and AVX state).
+		__cpuid(info, 1);
+		if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 0b110) != 0b110)
+			return false;
+
+		__cpuidex(info, 7, 0);
+		return info[1] & (1 << 5);
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+#endif
+
+	const LineTable& LineTable::Get()
+	{
+		static const LineTable table;
+		return table;
+	}
+
+	uint32_t LineTable::Pack(const unsigned char* memos, unsigned int fieldCount)
+	{
+		uint32_t packed = 0;
+		for (unsigned int i = 0; i < fieldCount; i++)
+			packed |= (uint32_t)(memos[i] & 0x0F) << (4 * i);
+		return packed;
+	}
+
+	LineTable::LineTable()
+		: m_Filter(FilterScalar), m_IsVectorized(false), m_Offsets(GetLookupSlotBase(MAX_FIELDS + 1) + 1)
+	{
+#ifdef LINE_TABLE_AVX2
+		if (IsAvx2Supported())
+		{
+			m_Filter = FilterAvx2;
+			m_IsVectorized = true;
+		}
+#endif
+
+		//	Enumerate every assignment of every field count as a base-4 number of types, and sort them into the slots of their volts and points.
+		//	The first pass counts the assignments per slot, the second one places them.
+		for (unsigned int pass = 0; pass < 2; pass++)
+		{
+			if (pass == 1)
+			{
+				unsigned int total = 0;
+				for (unsigned int& offset : m_Offsets)
+				{
+					unsigned int count = offset;
+					offset = total;
+					total += count;
+				}
+				m_Assignments.resize(total);
+			}
+
+			std::vector<unsigned int> next(m_Offsets);
+			for (unsigned int fieldCount = 1; fieldCount <= MAX_FIELDS; fieldCount++)
+			{
+				for (uint32_t code = 0; code < (1U << (2 * fieldCount)); code++)
+				{
+					uint32_t assignment = 0;
+					unsigned int points = 0;
+					unsigned int volts = 0;
+					for (unsigned int i = 0; i < fieldCount; i++)
+					{
+						unsigned int type = (code >> (2 * i)) & 3;
+						assignment |= TYPE_MEMOS[type] << (4 * i);
+						points += TYPE_POINTS[type];
+						volts += type == 3;
+					}
+
+					unsigned int slot = GetLookupSlot(fieldCount, volts, points);
+					if (pass == 0)
+						m_Offsets[slot]++;
+					else
+						m_Assignments[next[slot]++] = assignment;
+				}
+			}
+		}
+	}
+
+	uint32_t LineTable::Solve(unsigned int slot, uint32_t allowed) const
+	{
+		return m_Filter(m_Assignments.data() + m_Offsets[slot], m_Offsets[slot + 1] - m_Offsets[slot], allowed);
+	}
+
+	size_t LineTable::GetByteSize() const
+	{
+		return sizeof(unsigned int) * m_Offsets.capacity() + sizeof(uint32_t) * m_Assignments.capacity();
+	}
+
+	bool LineTable::IsVectorized() const
+	{
+		return m_IsVectorized;
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace VF
+{
+	//	Every legal assignment of the unconfirmed fields of a column/row with up to MAX_FIELDS of them, for every count of missing volts and points.
+	//	An assignment is packed into one word with a nibble per field, holding the one memo bit of its type (see Solver::MEMO_TYPE), field 0 in the lowest nibble.
+	//	A line is solved exactly by keeping the assignments that only use types still allowed by the memos, and OR-ing them together.
+	class LineTable
+	{
+	public:
+		static constexpr unsigned int MAX_FIELDS = 8;
+
+		//	Gets the table, which is built once on first use and shared by all solvers.
+		static const LineTable& Get();
+
+		//	Packs the memos of some fields into one word with a nibble per field, like an assignment.
+		static uint32_t Pack(const unsigned char* memos, unsigned int fieldCount);
+
+		//	Gets the OR of all assignments of the slot (see GetLookupSlot()) that only use types allowed by the packed memos, 0 if there is none.
+		uint32_t Solve(unsigned int slot, uint32_t allowed) const;
+
+		//	Gets the count of bytes held by the table.
+		size_t GetByteSize() const;
+
+		//	Gets whether Solve() uses the AVX2 kernel, which is selected at runtime if the CPU supports it.
+		bool IsVectorized() const;
+
+	private:
+		//	Kernel ORing all assignments that only use allowed types, one implementation per instruction set.
+		using Filter = uint32_t (*)(const uint32_t* assignments, unsigned int count, uint32_t allowed);
+
+		LineTable();
+
+		Filter m_Filter;
+		bool m_IsVectorized;
+
+		//	Per lookup slot: index of its first assignment in m_Assignments, followed by one more offset for the end of the last slot.
+		std::vector<unsigned int> m_Offsets;
+
+		std::vector<uint32_t> m_Assignments;
+	};
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+namespace VF
+{
+	//	Count of each type in one arrangement of the missing fields of a column/row, regardless of the order of the fields.
+	struct MemoCounts
+	{
+		unsigned char memo1;
+		unsigned char memo2;
+		unsigned char memo3;
+		unsigned char memoV;
+	};
+
+	//	Index of the first lookup slot for a count of missing fields. Every count of missing fields has (missingFields + 1)^2 slots,
+	//	one per combination of missing volts and missing points, in the order in which Solver::Solve() indexes them.
+	constexpr unsigned int GetLookupSlotBase(unsigned int missingFields)
+	{
+		//	Sum of (fields + 1)^2 over all smaller counts of fields, i.e. 2^2 + ... + missingFields^2.
+		return missingFields * (missingFields + 1) * (2 * missingFields + 1) / 6 - 1;
+	}
+
+	//	Index of the lookup slot for a line with missing fields, volts and points. Within a count of missing fields, the slots are ordered
+	//	by the missing volts, and every count of volts has one slot per possible count of missing points.
+	constexpr unsigned int GetLookupSlot(unsigned int missingFields, unsigned int missingVolts, unsigned int missingPoints)
+	{
+		//	Every smaller count of volts v has (missingFields - v) * 2 + 1 slots.
+		unsigned int voltSlots = missingVolts * (2 * missingFields + 1) - missingVolts * (missingVolts - 1);
+		return GetLookupSlotBase(missingFields) + voltSlots + missingPoints - (missingFields - missingVolts) * 1;
+	}
+
+	//	Count of different arrangements of 1s, 2s and 3s on some fields that add up to the missing points.
+	constexpr unsigned int GetLookupPossibilityCount(unsigned int pointFields, unsigned int missingPoints)
+	{
+		unsigned int excessPoints = missingPoints - pointFields * 1;
+		unsigned int lackingPoints = pointFields * 3 - missingPoints;
+		return (excessPoints < lackingPoints ? excessPoints : lackingPoints) / 2 + 1;
+	}
+
+	//	Count of entries in a lookup table for all counts of missing fields up to maxFields.
+	constexpr unsigned int GetLookupEntryCount(unsigned int maxFields)
+	{
+		unsigned int entryCount = 0;
+		for (unsigned int missingFields = 1; missingFields <= maxFields; missingFields++)
+		{
+			for (unsigned int voltCount = 0; voltCount <= missingFields; voltCount++)
+			{
+				unsigned int pointFields = missingFields - voltCount;
+				for (unsigned int missingPoints = pointFields * 1; missingPoints <= pointFields * 3; missingPoints++)
+					entryCount += GetLookupPossibilityCount(pointFields, missingPoints);
+			}
+		}
+		return entryCount;
+	}
+
+	//	Read-only lookup table for all counts of missing fields up to MaxFields, laid out flat:
+	//	the entries of slot s are entries[offsets[s]] up to (excluding) entries[offsets[s + 1]].
+	template <unsigned int MaxFields>
+	struct LookupTable
+	{
+		static constexpr unsigned int SLOT_COUNT = GetLookupSlotBase(MaxFields + 1);
+		static constexpr unsigned int ENTRY_COUNT = GetLookupEntryCount(MaxFields);
+
+		unsigned int offsets[SLOT_COUNT + 1];
+		MemoCounts entries[ENTRY_COUNT];
+	};
+
+	//	Fills a flat lookup table for all counts of missing fields up to maxFields, with GetLookupSlotBase(maxFields + 1) + 1 offsets and GetLookupEntryCount(maxFields) entries.
+	//	Every slot lists the counts of 1s, 2s and 3s of all arrangements that add up to its missing points, regardless of the order of the fields.
+	constexpr void FillLookupTable(unsigned int maxFields, unsigned int* offsets, MemoCounts* entries)
+	{
+		unsigned int slot = 0;
+		unsigned int entry = 0;
+		for (unsigned int missingFields = 1; missingFields <= maxFields; missingFields++)
+		{
+			for (unsigned int voltCount = 0; voltCount <= missingFields; voltCount++)
+			{
+				unsigned int pointFields = missingFields - voltCount;
+				for (unsigned int missingPoints = pointFields * 1; missingPoints <= pointFields * 3; missingPoints++)
+				{
+					offsets[slot++] = entry;
+
+					//	Start with as many 3s as possible (and one 2 for an odd excess), the rest are 1s,
+					//	then keep redistributing a pair of (1, 3) into (2, 2) until either runs out.
+					unsigned int excessPoints = missingPoints - pointFields * 1;
+					unsigned int threes = excessPoints / 2;
+					unsigned int twos = excessPoints % 2;
+					unsigned int ones = pointFields - twos - threes;
+					while (true)
+					{
+						entries[entry++] = MemoCounts { (unsigned char)ones, (unsigned char)twos, (unsigned char)threes, (unsigned char)voltCount };
+						if (ones == 0 || threes == 0)
+							break;
+						ones--;
+						threes--;
+						twos += 2;
+					}
+				}
+			}
+		}
+		offsets[slot] = entry;
+	}
+
+	//	Generates the lookup table at compile time.
+	template <unsigned int MaxFields>
+	constexpr LookupTable<MaxFields> CreateLookupTable()
+	{
+		LookupTable<MaxFields> table {};
+		FillLookupTable(MaxFields, table.offsets, table.entries);
+		return table;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace VF
+{
+#ifdef _WIN32
+	MappedFile::MappedFile()
+		: m_Data(nullptr), m_Size(0), m_File(INVALID_HANDLE_VALUE), m_Mapping(nullptr)
+	{
+	}
+#else
+	MappedFile::MappedFile()
+		: m_Data(nullptr), m_Size(0)
+	{
+	}
+#endif
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	bool MappedFile::Open(const char* path)
+	{
+		Close();
+
+#ifdef _WIN32
+		m_File = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (m_File == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(m_File, &size) || size.QuadPart == 0 || (unsigned long long)size.QuadPart > (size_t)-1)
+		{
+			Close();
+			return false;
+		}
+
+		m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!m_Mapping)
+		{
+			Close();
+			return false;
+		}
+
+		m_Data = (const unsigned char*)MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!m_Data)
+		{
+			Close();
+			return false;
+		}
+		m_Size = (size_t)size.QuadPart;
+#else
+		int file = open(path, O_RDONLY);
+		if (file < 0)
+			return false;
+
+		//	The mapping keeps its own reference to the file, so the descriptor is not needed afterwards.
+		struct stat status;
+		void* data = MAP_FAILED;
+		if (fstat(file, &status) == 0 && status.st_size > 0)
+			data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_SHARED, file, 0);
+		close(file);
+		if (data == MAP_FAILED)
+			return false;
+
+		m_Data = (const unsigned char*)data;
+		m_Size = (size_t)status.st_size;
+#endif
+
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+#ifdef _WIN32
+		if (m_Data)
+			UnmapViewOfFile(m_Data);
+		if (m_Mapping)
+			CloseHandle(m_Mapping);
+		if (m_File != INVALID_HANDLE_VALUE)
+			CloseHandle(m_File);
+		m_Mapping = nullptr;
+		m_File = INVALID_HANDLE_VALUE;
+#else
+		if (m_Data)
+			munmap((void*)m_Data, m_Size);
+#endif
+
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+
+	bool MappedFile::IsOpen() const
+	{
+		return m_Data != nullptr;
+	}
+
+	const unsigned char* MappedFile::GetData() const
+	{
+		return m_Data;
+	}
+
+	size_t MappedFile::GetSize() const
+	{
+		return m_Size;
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+
+namespace VF
+{
+	//	Read-only view of a whole file mapped into memory, so readers use its bytes in place instead of reading and parsing them.
+	//	The pages are loaded by the OS on first access and shared between all processes mapping the same file.
+	class MappedFile
+	{
+	public:
+		MappedFile();
+
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		//	Maps a file, unmapping the previous one first. Returns false if the file can not be opened or mapped, or is empty.
+		bool Open(const char* path);
+
+		void Close();
+
+		bool IsOpen() const;
+
+		//	Gets the first byte of the file, aligned to at least a page, or nullptr if no file is open.
+		const unsigned char* GetData() const;
+
+		size_t GetSize() const;
+
+	private:
+		const unsigned char* m_Data;
+		size_t m_Size;
+
+#ifdef _WIN32
+		//	Handles of the file and of its mapping, void* to keep <windows.h> out of the header
+		void* m_File;
+		void* m_Mapping;
+#endif
+	};
+}
@@ -0,0 +1,357 @@
+#include "MoveSearch.h"
+
+#include "BoardCounter.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace VF
+{
+	//	Spreads the lower 32 bits of a mask to every other bit, so that bit n lands on the low bit of field n of a packed board.
+	static uint64_t SpreadBits(uint64_t mask)
+	{
+		mask &= 0xFFFFFFFFULL;
+		mask = (mask | (mask << 16)) & 0x0000FFFF0000FFFFULL;
+		mask = (mask | (mask << 8)) & 0x00FF00FF00FF00FFULL;
+		mask = (mask | (mask << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+		mask = (mask | (mask << 2)) & 0x3333333333333333ULL;
+		mask = (mask | (mask << 1)) & 0x5555555555555555ULL;
+		return mask;
+	}
+
+	//	Gets the low bit of every field of a packed board that holds a 2 or a 3 (VALUE_2 = 01, VALUE_3 = 10).
+	static uint64_t GetUsefulBits(uint64_t board)
+	{
+		return (board ^ (board >> 1)) & 0x5555555555555555ULL;
+	}
+
+	//	Gets the low bit of every field of a packed board that holds a volt (VALUE_VOLT = 11).
+	static uint64_t GetVoltBits(uint64_t board)
+	{
+		return (board & (board >> 1)) & 0x5555555555555555ULL;
+	}
+
+	MoveSearch::MoveSearch(unsigned int rows, unsigned int columns)
+		: m_Columns(columns), m_Rows(rows),
+		m_uPoint(nullptr), m_vPoint(nullptr), m_uVolt(nullptr), m_vVolt(nullptr),
+		m_BoardLimit(200000), m_NodeLimit(400000), m_NodeCount(0),
+		m_Enumerator(rows, columns, 1), m_IsSymmetric(false),
+		m_CanonicalGrid(rows * columns), m_ColumnOrder(columns), m_RowOrder(rows), m_SortKeys(rows + columns)
+	{
+	}
+
+	void MoveSearch::SetLimits(size_t boardLimit, size_t nodeLimit)
+	{
+		m_BoardLimit = boardLimit;
+		m_NodeLimit = nodeLimit;
+	}
+
+	size_t MoveSearch::GetNodeCount() const
+	{
+		return m_NodeCount;
+	}
+
+	MoveSearch::Result MoveSearch::FindBestMove(const unsigned int* uPoint, const unsigned int* vPoint, const unsigned int* uVolt, const unsigned int* vVolt, const unsigned char* memos, const bool* revealed)
+	{
+		m_uPoint = uPoint;
+		m_vPoint = vPoint;
+		m_uVolt = uVolt;
+		m_vVolt = vVolt;
+
+		m_NodeCount = 0;
+		m_Transpositions.clear();
+		m_Boards.clear();
+
+		unsigned int fieldCount = m_Columns * m_Rows;
+		if (fieldCount == 0 || fieldCount > MAX_FIELDS)
+			return FindHeuristicMove(uPoint, vPoint, uVolt, vVolt, memos, revealed);
+
+		//	1. Collect all consistent boards.
+		auto collect = [this](const uint64_t* board, unsigned int)
+		{
+			m_Boards.push_back(board[0]);
+			return m_Boards.size() <= m_BoardLimit;
+		};
+		if (m_Enumerator.Enumerate(uPoint, vPoint, uVolt, vVolt, memos, collect) > m_BoardLimit)
+		{
+			m_Boards.clear();
+			return FindHeuristicMove(uPoint, vPoint, uVolt, vVolt, memos, revealed);
+		}
+
+		Result result { false, true, 0, 0, 0.0 };
+		size_t boardCount = m_Boards.size();
+		if (boardCount == 0)
+			return result;
+
+		uint64_t revealedMask = 0;
+		for (unsigned int i = 0; i < fieldCount; i++)
+		{
+			if (revealed[i])
+				revealedMask |= 1ULL << i;
+		}
+
+		//	2. Compare against the boards allowed by the revealed fields alone. The memos only narrow that set, so equal counts mean equal sets.
+		std::vector<unsigned char> revealedMemos(fieldCount);
+		for (unsigned int i = 0; i < fieldCount; i++)
+			revealedMemos[i] = revealed[i] ? (memos[i] & 0x0F) : 0x0F;
+		BoardCounter counter(m_Rows, m_Columns);
+		m_IsSymmetric = counter.Count(uPoint, vPoint, uVolt, vVolt, revealedMemos.data(), nullptr, nullptr) == (double)boardCount;
+
+		//	3. Boards whose 2s and 3s are all revealed already are won, move the others to the front.
+		uint64_t unrevealedBits = SpreadBits(~revealedMask);
+		size_t openCount = 0;
+		for (size_t i = 0; i < boardCount; i++)
+		{
+			if (GetUsefulBits(m_Boards[i]) & unrevealedBits)
+				m_Boards[openCount++] = m_Boards[i];
+		}
+		m_Boards.resize(openCount);
+
+		if (openCount == 0)
+		{
+			result.winProbability = 1.0;
+			return result;
+		}
+
+		//	4. Search
+		unsigned int bestField = 0;
+		long long wonCount = Search(0, openCount, revealedMask, 0, 0, &bestField);
+		if (wonCount < 0)
+		{
+			m_Boards.clear();
+			return FindHeuristicMove(uPoint, vPoint, uVolt, vVolt, memos, revealed);
+		}
+
+		result.isValid = true;
+		result.column = bestField / m_Rows;
+		result.row = bestField % m_Rows;
+		result.winProbability = (double)(boardCount - openCount + wonCount) / boardCount;
+		return result;
+	}
+
+	long long MoveSearch::Search(size_t begin, size_t count, uint64_t revealedMask, unsigned int depth, long long neededCount, unsigned int* bestField)
+	{
+		if (count == 0)
+			return 0;
+
+		if (++m_NodeCount > m_NodeLimit)
+			return -1;
+
+		StateKey key {};
+		if (depth > 0)
+		{
+			key = GetCanonicalKey(revealedMask, m_Boards[begin]);
+			auto transposition = m_Transpositions.find(key);
+			if (transposition != m_Transpositions.end() && (transposition->second.isExact || (long long)transposition->second.wonCount < neededCount))
+				return transposition->second.wonCount;
+		}
+
+		//	1. Count per field in how many boards it is a volt, and in how many it is worth flipping.
+		unsigned int fieldCount = m_Columns * m_Rows;
+		unsigned int voltCounts[MAX_FIELDS] = {};
+		unsigned int usefulCounts[MAX_FIELDS] = {};
+		uint64_t unrevealedBits = SpreadBits(~revealedMask & ((1ULL << fieldCount) - 1));
+		for (size_t i = begin; i < begin + count; i++)
+		{
+			for (uint64_t bits = GetVoltBits(m_Boards[i]) & unrevealedBits; bits; bits &= bits - 1)
+				voltCounts[std::countr_zero(bits) / 2]++;
+			for (uint64_t bits = GetUsefulBits(m_Boards[i]) & unrevealedBits; bits; bits &= bits - 1)
+				usefulCounts[std::countr_zero(bits) / 2]++;
+		}
+
+		//	2. Candidates are the fields that could still be a 2 or 3. A field that is never a volt can be flipped without risk
+		//	and only adds information, so it is taken right away. The others are tried safest first.
+		unsigned int candidates[MAX_FIELDS];
+		unsigned int candidateCount = 0;
+		for (unsigned int f = 0; f < fieldCount; f++)
+		{
+			if (!usefulCounts[f])
+				continue;
+
+			if (voltCounts[f] == 0)
+			{
+				candidates[0] = f;
+				candidateCount = 1;
+				break;
+			}
+			candidates[candidateCount++] = f;
+		}
+		std::sort(candidates, candidates + candidateCount, [&voltCounts](unsigned int a, unsigned int b) { return voltCounts[a] < voltCounts[b]; });
+
+		//	A field is only searched further while it can still beat both the best field so far and what the caller needs.
+		long long bestWonCount = -1;
+		long long wonBound = -1;
+		for (unsigned int c = 0; c < candidateCount; c++)
+		{
+			unsigned int field = candidates[c];
+			long long threshold = std::max(bestWonCount, neededCount - 1);
+
+			//	Flipping this field loses every board in which it is a volt, so it can not beat the threshold if that is not enough.
+			//	The candidates are sorted by their volts, so neither can any later one.
+			if ((long long)(count - voltCounts[field]) <= threshold)
+			{
+				wonBound = std::max(wonBound, (long long)(count - voltCounts[field]));
+				break;
+			}
+
+			//	3. Partition the boards by the value of the field, boards that have all their 2s and 3s revealed afterwards are won.
+			uint64_t childRevealedMask = revealedMask | (1ULL << field);
+			uint64_t childUnrevealedBits = unrevealedBits & ~(3ULL << (2 * field));
+			size_t top = m_Boards.size();
+
+			//	Every board of a child that is not won lowers the best this field can reach, stop once it can not beat the threshold any more.
+			long long wonCount = 0;
+			long long wonLimit = (long long)(count - voltCounts[field]);
+			for (unsigned int value = BoardCounter::VALUE_1; value <= BoardCounter::VALUE_3 && wonLimit > threshold; value++)
+			{
+				size_t childBegin = m_Boards.size();
+				for (size_t i = begin; i < begin + count; i++)
+				{
+					uint64_t board = m_Boards[i];
+					if (((board >> (2 * field)) & 3) != value)
+						continue;
+
+					if (GetUsefulBits(board) & childUnrevealedBits)
+						m_Boards.push_back(board);
+					else
+						wonCount++;
+				}
+
+				size_t childCount = m_Boards.size() - childBegin;
+				//	The child has to win this many boards for the field to stay above the threshold, below that its count may only be an upper bound.
+				long long childNeededCount = threshold - wonLimit + (long long)childCount + 1;
+				long long childWonCount = Search(childBegin, childCount, childRevealedMask, depth + 1, childNeededCount, nullptr);
+				m_Boards.resize(childBegin);
+				if (childWonCount < 0)
+				{
+					m_Boards.resize(top);
+					return -1;
+				}
+				wonCount += childWonCount;
+				wonLimit -= (long long)childCount - childWonCount;
+			}
+			m_Boards.resize(top);
+
+			//	wonLimit ends above the threshold only if every child was searched to its exact count, then it equals wonCount.
+			wonBound = std::max(wonBound, wonLimit);
+			if (wonLimit > threshold)
+			{
+				bestWonCount = wonCount;
+				if (bestField)
+					*bestField = field;
+			}
+
+			if (bestWonCount == (long long)count)
+				break;
+		}
+
+		//	If no field reaches what the caller needs, only an upper bound is known unless every field was searched to the end.
+		long long result = bestWonCount >= neededCount ? bestWonCount : std::max(bestWonCount, wonBound);
+		if (depth > 0)
+			m_Transpositions[key] = Transposition { (unsigned int)result, result == bestWonCount };
+
+		return result;
+	}
+
+	MoveSearch::StateKey MoveSearch::GetCanonicalKey(uint64_t revealedMask, uint64_t board)
+	{
+		//	Grid of the revealed state: 0 for unrevealed fields, otherwise the value + 1.
+		for (unsigned int f = 0; f < m_Columns * m_Rows; f++)
+			m_CanonicalGrid[f] = ((revealedMask >> f) & 1) ? (unsigned char)(((board >> (2 * f)) & 3) + 1) : 0;
+
+		for (unsigned int u = 0; u < m_Columns; u++)
+			m_ColumnOrder[u] = u;
+		for (unsigned int v = 0; v < m_Rows; v++)
+			m_RowOrder[v] = v;
+
+		//	Sort the columns by their hints and then by their revealed content, then the rows in the same way, twice.
+		//	Only lines with equal hints can change places relative to each other, so two states with the same key are equivalent,
+		//	though not every pair of equivalent states is guaranteed to get the same key.
+		//	A signature holds a line of up to StateKey::FIELDS_PER_WORD fields. Only a board with a single line across can have longer lines,
+		//	and that line has nothing to be sorted against.
+		uint64_t* columnSignatures = m_SortKeys.data();
+		uint64_t* rowSignatures = m_SortKeys.data() + m_Columns;
+		for (unsigned int iteration = 0; m_IsSymmetric && iteration < 2; iteration++)
+		{
+			for (unsigned int u = 0; u < m_Columns; u++)
+			{
+				columnSignatures[u] = 0;
+				for (unsigned int j = 0; j < m_Rows; j++)
+					columnSignatures[u] = (columnSignatures[u] << StateKey::FIELD_BITS) | m_CanonicalGrid[u * m_Rows + m_RowOrder[j]];
+			}
+			std::sort(m_ColumnOrder.begin(), m_ColumnOrder.end(), [this, columnSignatures](unsigned int a, unsigned int b)
+			{
+				if (m_uPoint[a] != m_uPoint[b])
+					return m_uPoint[a] < m_uPoint[b];
+				if (m_uVolt[a] != m_uVolt[b])
+					return m_uVolt[a] < m_uVolt[b];
+				return columnSignatures[a] < columnSignatures[b];
+			});
+
+			for (unsigned int v = 0; v < m_Rows; v++)
+			{
+				rowSignatures[v] = 0;
+				for (unsigned int k = 0; k < m_Columns; k++)
+					rowSignatures[v] = (rowSignatures[v] << StateKey::FIELD_BITS) | m_CanonicalGrid[m_ColumnOrder[k] * m_Rows + v];
+			}
+			std::sort(m_RowOrder.begin(), m_RowOrder.end(), [this, rowSignatures](unsigned int a, unsigned int b)
+			{
+				if (m_vPoint[a] != m_vPoint[b])
+					return m_vPoint[a] < m_vPoint[b];
+				if (m_vVolt[a] != m_vVolt[b])
+					return m_vVolt[a] < m_vVolt[b];
+				return rowSignatures[a] < rowSignatures[b];
+			});
+		}
+
+		StateKey key {};
+		unsigned int f = 0;
+		for (unsigned int k = 0; k < m_Columns; k++)
+		{
+			for (unsigned int j = 0; j < m_Rows; j++, f++)
+			{
+				uint64_t& word = key.words[f / StateKey::FIELDS_PER_WORD];
+				word = (word << StateKey::FIELD_BITS) | m_CanonicalGrid[m_ColumnOrder[k] * m_Rows + m_RowOrder[j]];
+			}
+		}
+		return key;
+	}
+
+	MoveSearch::Result MoveSearch::FindHeuristicMove(const unsigned int* uPoint, const unsigned int* vPoint, const unsigned int* uVolt, const unsigned int* vVolt, const unsigned char* memos, const bool* revealed) const
+	{
+		Result result { false, false, 0, 0, 0.0 };
+
+		std::vector<double> probabilities(m_Columns * m_Rows * BoardCounter::VALUE_COUNT);
+		BoardCounter counter(m_Rows, m_Columns);
+		double boardCount = counter.Count(uPoint, vPoint, uVolt, vVolt, memos, probabilities.data(), nullptr);
+		if (boardCount <= 0.0)
+			return result;
+
+		//	Flip the field least likely to be a volt among those that could be a 2 or 3, preferring the more likely 2 or 3 on a tie.
+		double bestSafe = -1.0;
+		double bestUseful = -1.0;
+		for (unsigned int f = 0; f < m_Columns * m_Rows; f++)
+		{
+			if (revealed[f])
+				continue;
+
+			const double* counts = probabilities.data() + f * BoardCounter::VALUE_COUNT;
+			double useful = (counts[BoardCounter::VALUE_2] + counts[BoardCounter::VALUE_3]) / boardCount;
+			double safe = 1.0 - counts[BoardCounter::VALUE_VOLT] / boardCount;
+			if (useful <= 0.0)
+				continue;
+
+			if (safe > bestSafe || (safe == bestSafe && useful > bestUseful))
+			{
+				bestSafe = safe;
+				bestUseful = useful;
+				result.isValid = true;
+				result.column = f / m_Rows;
+				result.row = f % m_Rows;
+				result.winProbability = safe;
+			}
+		}
+
+		return result;
+	}
+}
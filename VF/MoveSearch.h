@@ -0,0 +1,117 @@
+#pragma once
+
+#include "BoardEnumerator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+namespace VF
+{
+	//	Result of MoveSearch::FindBestMove(), outside of the class so that Solver.h can declare it without including this header.
+	struct MoveResult
+	{
+		bool isValid;			//	Whether there is any field left worth flipping.
+		bool isExact;			//	Whether the search finished. If not, the move is the safest useful flip according to the board probabilities.
+		unsigned int column;
+		unsigned int row;
+		double winProbability;	//	Probability to clear the board with optimal play if exact, otherwise only the probability that the recommended field is not a volt.
+	};
+
+	//	Searches for the field to flip next that maximizes the probability to clear the board, i.e. to flip every 2 and 3.
+	//	The search is an expectimax over the outcomes of every flip, weighted by how many consistent boards remain, over the list of all
+	//	boards consistent with the hints and memos. A transposition table keyed on the canonical revealed state (row/column permutations
+	//	that preserve the hints map to the same key) makes sure repeated subtrees are only solved once.
+	class MoveSearch
+	{
+	public:
+		using Result = MoveResult;
+
+		//	Boards with more fields than this can not be searched exactly.
+		static constexpr unsigned int MAX_FIELDS = 32;
+
+		MoveSearch(unsigned int rows, unsigned int columns);
+
+		//	Sets the maximum count of consistent boards and of search nodes before falling back to the heuristic.
+		//	The defaults of 200000 boards and 400000 nodes keep a search of a 5x5 board under about half a second.
+		//	Offline tools like VFBook raise them, since the few boards that need more can take minutes.
+		void SetLimits(size_t boardLimit, size_t nodeLimit);
+
+		//	Finds the best field to flip. memos is the column-major matrix of memos, revealed marks the fields that were already flipped.
+		Result FindBestMove(const unsigned int* uPoint, const unsigned int* vPoint, const unsigned int* uVolt, const unsigned int* vVolt, const unsigned char* memos, const bool* revealed);
+
+		//	Gets the count of search nodes visited by the last FindBestMove().
+		size_t GetNodeCount() const;
+
+	private:
+		//	Returns the count of boards in the range that are won with optimal play, or -1 if the node limit was hit. Writes the best field to bestField if not null.
+		//	A count below neededCount may only be an upper bound: the caller just needs to know that the range can not win as many boards.
+		long long Search(size_t begin, size_t count, uint64_t revealedMask, unsigned int depth, long long neededCount, unsigned int* bestField);
+
+		//	Revealed state with FIELD_BITS per field, 0 for unrevealed fields, otherwise the value + 1. MAX_FIELDS fields need two words.
+		struct StateKey
+		{
+			static constexpr unsigned int FIELD_BITS = 3;
+			static constexpr unsigned int FIELDS_PER_WORD = 64 / FIELD_BITS;
+
+			uint64_t words[2];
+
+			bool operator==(const StateKey& other) const
+			{
+				return words[0] == other.words[0] && words[1] == other.words[1];
+			}
+		};
+
+		static_assert(2 * StateKey::FIELDS_PER_WORD >= MAX_FIELDS, "A key has to hold every field");
+
+		struct StateKeyHash
+		{
+			size_t operator()(const StateKey& key) const
+			{
+				uint64_t hash = (key.words[0] ^ (key.words[1] * 0x9E3779B97F4A7C15ULL)) * 0xBF58476D1CE4E5B9ULL;
+				return (size_t)(hash ^ (hash >> 31));
+			}
+		};
+
+		StateKey GetCanonicalKey(uint64_t revealedMask, uint64_t board);
+
+		Result FindHeuristicMove(const unsigned int* uPoint, const unsigned int* vPoint, const unsigned int* uVolt, const unsigned int* vVolt, const unsigned char* memos, const bool* revealed) const;
+
+		unsigned int const m_Columns;
+		unsigned int const m_Rows;
+
+		const unsigned int* m_uPoint;
+		const unsigned int* m_vPoint;
+		const unsigned int* m_uVolt;
+		const unsigned int* m_vVolt;
+
+		size_t m_BoardLimit;
+		size_t m_NodeLimit;
+		size_t m_NodeCount;
+
+		//	Lists the consistent boards on the calling thread, a board of at most MAX_FIELDS fields is a single word.
+		BoardEnumerator m_Enumerator;
+
+		//	All consistent boards, 2 bits per field in column-major order holding a BoardCounter::VALUE, followed by the partitions of every search depth.
+		std::vector<uint64_t> m_Boards;
+
+		struct Transposition
+		{
+			unsigned int wonCount;
+			bool isExact;		//	Otherwise wonCount is an upper bound, see Search().
+		};
+
+		//	Canonical revealed state -> count of boards won with optimal play
+		std::unordered_map<StateKey, Transposition, StateKeyHash> m_Transpositions;
+
+		//	Whether the memos of the unrevealed fields follow from the hints and the revealed fields alone, only then lines with equal hints may be swapped.
+		bool m_IsSymmetric;
+
+		//	Scratch for GetCanonicalKey()
+		std::vector<unsigned char> m_CanonicalGrid;
+		std::vector<unsigned int> m_ColumnOrder;
+		std::vector<unsigned int> m_RowOrder;
+		std::vector<uint64_t> m_SortKeys;
+	};
+}
@@ -0,0 +1,237 @@
+#include "OpeningBook.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace VF
+{
+	static constexpr char BOOK_MAGIC[4] = { 'V', 'F', 'O', 'B' };
+
+	//	Sort code of a line: lines with equal codes have equal hints.
+	static unsigned int GetLineCode(unsigned int points, unsigned int volts)
+	{
+		return (points << 4) | volts;
+	}
+
+	//	Sorts the line indices by their codes, ties keep their order so that the result does not depend on the sort implementation.
+	static void SortLines(unsigned int count, const unsigned int* codes, unsigned char* order)
+	{
+		for (unsigned int i = 0; i < count; i++)
+			order[i] = (unsigned char)i;
+		std::stable_sort(order, order + count, [codes](unsigned char a, unsigned char b) { return codes[a] < codes[b]; });
+	}
+
+	//	Byte of a line in CanonicalHints::lines.
+	static unsigned char GetLineByte(unsigned int points, unsigned int volts)
+	{
+		const unsigned int maxPoints = 3 * OpeningBook::MAX_DIM;
+		if (points > maxPoints || volts > OpeningBook::MAX_DIM)
+			return OpeningBook::LINE_INVALID;
+		return (unsigned char)(volts * (maxPoints + 1) + points);
+	}
+
+	//	Orders entries by key, and entries with the same key by their hints.
+	static bool IsEntryBefore(const OpeningBook::Entry& a, const OpeningBook::Entry& b)
+	{
+		return a.key != b.key ? a.key < b.key : std::memcmp(a.lines, b.lines, sizeof(a.lines)) < 0;
+	}
+
+	static uint64_t MixKey(uint64_t key, unsigned int value)
+	{
+		key = (key ^ value) * 0x9E3779B97F4A7C15ULL;
+		return key ^ (key >> 29);
+	}
+
+	OpeningBook::OpeningBook()
+		: m_Header(nullptr), m_Entries(nullptr)
+	{
+	}
+
+	bool OpeningBook::Open(const char* path)
+	{
+		Close();
+
+		if (!m_File.Open(path) || m_File.GetSize() < sizeof(Header))
+		{
+			m_File.Close();
+			return false;
+		}
+
+		const Header* header = (const Header*)m_File.GetData();
+		if (std::memcmp(header->magic, BOOK_MAGIC, sizeof(BOOK_MAGIC)) != 0 || header->version != VERSION ||
+			header->rows == 0 || header->rows > MAX_DIM || header->columns == 0 || header->columns > MAX_DIM ||
+			header->entryCount != (m_File.GetSize() - sizeof(Header)) / sizeof(Entry) || (m_File.GetSize() - sizeof(Header)) % sizeof(Entry) != 0)
+		{
+			m_File.Close();
+			return false;
+		}
+
+		//	The mapping is page-aligned, so the entries right after the header are aligned for their keys.
+		m_Header = header;
+		m_Entries = (const Entry*)(m_File.GetData() + sizeof(Header));
+		return true;
+	}
+
+	void OpeningBook::Close()
+	{
+		m_File.Close();
+		m_Header = nullptr;
+		m_Entries = nullptr;
+	}
+
+	bool OpeningBook::IsOpen() const
+	{
+		return m_Header != nullptr;
+	}
+
+	unsigned int OpeningBook::GetColumnCount() const
+	{
+		return m_Header ? m_Header->columns : 0;
+	}
+
+	unsigned int OpeningBook::GetRowCount() const
+	{
+		return m_Header ? m_Header->rows : 0;
+	}
+
+	size_t OpeningBook::GetEntryCount() const
+	{
+		return m_Header ? (size_t)m_Header->entryCount : 0;
+	}
+
+	const OpeningBook::Entry* OpeningBook::GetEntries() const
+	{
+		return m_Entries;
+	}
+
+	bool OpeningBook::Find(unsigned int rows, unsigned int columns, const unsigned int* uPoint, const unsigned int* vPoint, const unsigned int* uVolt, const unsigned int* vVolt,
+		MoveSearch::Result& result) const
+	{
+		if (!m_Header || rows != m_Header->rows || columns != m_Header->columns)
+			return false;
+
+		CanonicalHints hints = Canonicalize(rows, columns, uPoint, vPoint, uVolt, vVolt);
+
+		if (std::find(hints.lines, hints.lines + sizeof(hints.lines), LINE_INVALID) != hints.lines + sizeof(hints.lines))
+			return false;
+
+		//	Other hints may share the key, only an entry with the same hints holds the move.
+		const Entry* end = m_Entries + m_Header->entryCount;
+		const Entry* entry = std::lower_bound(m_Entries, end, hints.key, [](const Entry& entry, uint64_t key) { return entry.key < key; });
+		while (entry != end && entry->key == hints.key && std::memcmp(entry->lines, hints.lines, sizeof(hints.lines)) != 0)
+			entry++;
+		if (entry == end || entry->key != hints.key)
+			return false;
+
+		//	The entry comes from the file as it is, a foreign or damaged book may point outside of the board.
+		if (entry->column >= hints.columns || entry->row >= hints.rows)
+			return false;
+
+		//	The canonical columns are the original rows of a transposed board.
+		unsigned int column = hints.isTransposed ? hints.rowOrigin[entry->row] : hints.columnOrigin[entry->column];
+		unsigned int row = hints.isTransposed ? hints.columnOrigin[entry->column] : hints.rowOrigin[entry->row];
+
+		result = MoveSearch::Result { (entry->flags & ENTRY_VALID) != 0, (entry->flags & ENTRY_EXACT) != 0, column, row, entry->winProbability };
+		return true;
+	}
+
+	OpeningBook::CanonicalHints OpeningBook::Canonicalize(unsigned int rows, unsigned int columns, const unsigned int* uPoint, const unsigned int* vPoint, const unsigned int* uVolt, const unsigned int* vVolt)
+	{
+		unsigned int columnCodes[MAX_DIM] {};
+		unsigned int rowCodes[MAX_DIM] {};
+		for (unsigned int u = 0; u < columns; u++)
+			columnCodes[u] = GetLineCode(uPoint[u], uVolt[u]);
+		for (unsigned int v = 0; v < rows; v++)
+			rowCodes[v] = GetLineCode(vPoint[v], vVolt[v]);
+
+		unsigned char columnOrder[MAX_DIM] {};
+		unsigned char rowOrder[MAX_DIM] {};
+		SortLines(columns, columnCodes, columnOrder);
+		SortLines(rows, rowCodes, rowOrder);
+
+		//	A square board is transposed if its sorted rows followed by its sorted columns come first.
+		bool isTransposed = false;
+		if (rows == columns)
+		{
+			for (unsigned int i = 0; i < 2 * columns; i++)
+			{
+				unsigned int code = i < columns ? columnCodes[columnOrder[i]] : rowCodes[rowOrder[i - columns]];
+				unsigned int transposedCode = i < columns ? rowCodes[rowOrder[i]] : columnCodes[columnOrder[i - columns]];
+				if (code != transposedCode)
+				{
+					isTransposed = transposedCode < code;
+					break;
+				}
+			}
+		}
+
+		CanonicalHints hints {};
+		hints.isTransposed = isTransposed;
+		hints.columns = isTransposed ? rows : columns;
+		hints.rows = isTransposed ? columns : rows;
+		for (unsigned int u = 0; u < hints.columns; u++)
+		{
+			unsigned int origin = isTransposed ? rowOrder[u] : columnOrder[u];
+			hints.columnOrigin[u] = (unsigned char)origin;
+			hints.uPoint[u] = isTransposed ? vPoint[origin] : uPoint[origin];
+			hints.uVolt[u] = isTransposed ? vVolt[origin] : uVolt[origin];
+		}
+		for (unsigned int v = 0; v < hints.rows; v++)
+		{
+			unsigned int origin = isTransposed ? columnOrder[v] : rowOrder[v];
+			hints.rowOrigin[v] = (unsigned char)origin;
+			hints.vPoint[v] = isTransposed ? uPoint[origin] : vPoint[origin];
+			hints.vVolt[v] = isTransposed ? uVolt[origin] : vVolt[origin];
+		}
+
+		for (unsigned int u = 0; u < hints.columns; u++)
+			hints.lines[u] = GetLineByte(hints.uPoint[u], hints.uVolt[u]);
+		for (unsigned int v = 0; v < hints.rows; v++)
+			hints.lines[hints.columns + v] = GetLineByte(hints.vPoint[v], hints.vVolt[v]);
+
+		uint64_t key = MixKey(0xCBF29CE484222325ULL, (hints.rows << 8) | hints.columns);
+		for (unsigned int u = 0; u < hints.columns; u++)
+			key = MixKey(key, GetLineCode(hints.uPoint[u], hints.uVolt[u]));
+		for (unsigned int v = 0; v < hints.rows; v++)
+			key = MixKey(key, GetLineCode(hints.vPoint[v], hints.vVolt[v]));
+		hints.key = key;
+
+		return hints;
+	}
+
+	OpeningBook::Header OpeningBook::CreateHeader(unsigned int rows, unsigned int columns, size_t entryCount)
+	{
+		Header header {};
+		std::memcpy(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC));
+		header.version = VERSION;
+		header.rows = rows;
+		header.columns = columns;
+		header.entryCount = entryCount;
+		return header;
+	}
+
+	bool OpeningBook::Write(const char* path, unsigned int rows, unsigned int columns, std::vector<Entry>& entries)
+	{
+		std::stable_sort(entries.begin(), entries.end(), IsEntryBefore);
+		entries.erase(std::unique(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return !IsEntryBefore(a, b) && !IsEntryBefore(b, a); }), entries.end());
+
+		Header header = CreateHeader(rows, columns, entries.size());
+
+		std::string tempPath = std::string(path) + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			file.write((const char*)&header, sizeof(header));
+			file.write((const char*)entries.data(), (std::streamsize)(entries.size() * sizeof(Entry)));
+			file.close();
+			if (!file)
+				return false;
+		}
+
+		std::error_code error;
+		std::filesystem::rename(tempPath, path, error);
+		return !error;
+	}
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "MoveSearch.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace VF
+{
+	//	Best first moves of boards with nothing revealed yet, looked up by their hints in a file built offline by VFBook.
+	//	The file is a Header followed by Entries sorted by key, in the byte order of the machine. It is mapped into memory and binary-searched in place,
+	//	so opening it costs no parsing and a lookup touches a handful of pages.
+	//	Boards whose hints only differ by a permutation of the columns, of the rows or, on square boards, by a transposition have the same first move
+	//	up to that permutation, so entries are stored once for the canonical hints (see Canonicalize()). Every entry also holds its canonical hints,
+	//	so hints whose keys collide are told apart instead of getting the move of another board.
+	class OpeningBook
+	{
+	public:
+		static constexpr unsigned int VERSION = 2;
+
+		//	Longest line of a board the book can hold.
+		static constexpr unsigned int MAX_DIM = 8;
+
+		struct Header
+		{
+			char magic[4];			//	"VFOB"
+			uint32_t version;
+			uint32_t rows;
+			uint32_t columns;
+			uint64_t entryCount;
+		};
+
+		enum ENTRY_FLAG : unsigned char
+		{
+			ENTRY_VALID = 0b01,		//	There is a field worth flipping, see MoveSearch::Result::isValid.
+			ENTRY_EXACT = 0b10		//	The move search finished, see MoveSearch::Result::isExact.
+		};
+
+		//	Best first move for one canonical set of hints, with the column and row in canonical order.
+		struct Entry
+		{
+			uint64_t key;
+			float winProbability;
+			unsigned char column;
+			unsigned char row;
+			unsigned char flags;
+			unsigned char reserved;
+			unsigned char lines[2 * MAX_DIM];	//	Canonical hints, see CanonicalHints::lines
+		};
+
+		//	Hints with the columns and the rows sorted, and on square boards transposed if that sorts first.
+		struct CanonicalHints
+		{
+			unsigned int rows;
+			unsigned int columns;
+			unsigned int uPoint[MAX_DIM];
+			unsigned int vPoint[MAX_DIM];
+			unsigned int uVolt[MAX_DIM];
+			unsigned int vVolt[MAX_DIM];
+
+			//	Line of the original hints that canonical column/row i came from. If transposed, the canonical columns are the original rows and vice versa.
+			unsigned char columnOrigin[MAX_DIM];
+			unsigned char rowOrigin[MAX_DIM];
+			bool isTransposed;
+
+			//	A byte per canonical column followed by one per row, volts * (3 * MAX_DIM + 1) + points, the rest 0.
+			//	Lines whose hints can not occur on a board of MAX_DIM fields are LINE_INVALID, such hints are never found.
+			unsigned char lines[2 * MAX_DIM];
+
+			//	64-bit hash of the canonical hints, the key of the entries
+			uint64_t key;
+		};
+
+		static constexpr unsigned char LINE_INVALID = 0xFF;
+
+		OpeningBook();
+
+		OpeningBook(const OpeningBook&) = delete;
+		OpeningBook& operator=(const OpeningBook&) = delete;
+
+		//	Maps a book file, returns false if it can not be mapped or its header or size do not match.
+		bool Open(const char* path);
+
+		void Close();
+
+		bool IsOpen() const;
+
+		unsigned int GetColumnCount() const;
+		unsigned int GetRowCount() const;
+
+		size_t GetEntryCount() const;
+
+		//	Gets the entries in ascending order of their keys, they stay valid until the book is closed.
+		const Entry* GetEntries() const;
+
+		//	Looks up the first move of a board with these hints and nothing revealed, and writes it in the coordinates of these hints to result.
+		//	Returns false if the board is not in the book.
+		bool Find(unsigned int rows, unsigned int columns, const unsigned int* uPoint, const unsigned int* vPoint, const unsigned int* uVolt, const unsigned int* vVolt,
+			MoveSearch::Result& result) const;
+
+		//	Gets the canonical form of hints. Both dimensions must be at most MAX_DIM.
+		static CanonicalHints Canonicalize(unsigned int rows, unsigned int columns, const unsigned int* uPoint, const unsigned int* vPoint, const unsigned int* uVolt, const unsigned int* vVolt);
+
+		//	Gets the header of a book file with entryCount entries.
+		static Header CreateHeader(unsigned int rows, unsigned int columns, size_t entryCount);
+
+		//	Sorts the entries by key, drops all but the first entry of the same hints and writes them as a book file. Writes to a temporary file that replaces path once complete,
+		//	so a reader or an interrupted build never sees half a book. Returns false if the file can not be written.
+		static bool Write(const char* path, unsigned int rows, unsigned int columns, std::vector<Entry>& entries);
+
+	private:
+		MappedFile m_File;
+
+		const Header* m_Header;
+		const Entry* m_Entries;
+	};
+
+	static_assert(sizeof(OpeningBook::Header) == 24 && sizeof(OpeningBook::Entry) == 32, "The book layout is part of the file format");
+	static_assert(std::is_trivially_copyable_v<OpeningBook::Header> && std::is_trivially_copyable_v<OpeningBook::Entry>, "Book records are used in place");
+}
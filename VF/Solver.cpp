@@ -1,8 +1,21 @@
 #include "Solver.h"
 
+#include "BoardCounter.h"
+#include "BoardEnumerator.h"
+#include "BoardFile.h"
+#include "GameLevels.h"
+#include "LineTable.h"
+#include "LookupTable.h"
+#include "MoveSearch.h"
+#include "OpeningBook.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
 #include <cstring>
+#include <bit>
 #include <iostream>
 #include <iomanip>
+#include <new>
 
 namespace VF
 {
@@ -12,41 +25,66 @@ namespace VF
 
 #define MAX_DIM 255U
 
+#define STATIC_LOOKUP_MAX_FIELDS 5U
+
+#define LINE_CACHE_CAPACITY 4096U
+
+#define PARALLEL_MIN_DIM 16U
+
+#if VF_SOLVER_STATS
+#define STAT_INC(counter) ((counter)++)
+#define STAT_ADD(counter, count) ((counter) += (count))
+#else
+#define STAT_INC(counter) ((void)0)
+#define STAT_ADD(counter, count) ((void)0)
+#endif
+
+	//	Lookup table for the standard 5x5 board, generated at compile time.
+	static constexpr LookupTable<STATIC_LOOKUP_MAX_FIELDS> STATIC_LOOKUP_TABLE = CreateLookupTable<STATIC_LOOKUP_MAX_FIELDS>();
+
+	//	Size in bytes of a lookup arena for all counts of missing fields up to maxFields.
+	static size_t GetLookupArenaSize(unsigned int maxFields)
+	{
+		return sizeof(unsigned int) * (GetLookupSlotBase(maxFields + 1) + 1) + sizeof(MemoCounts) * GetLookupEntryCount(maxFields);
+	}
+
 	Solver::Solver(unsigned int rows, unsigned int columns)
 		: m_IsLookupInitialized(false),
 		m_Columns(min(columns, MAX_DIM)), m_Rows(min(rows, MAX_DIM)),
+		m_IsStaticLookup(max(m_Columns, m_Rows) <= STATIC_LOOKUP_MAX_FIELDS),
 		m_uPoint(new unsigned int[m_Columns] {}), m_vPoint(new unsigned int[m_Rows] {}),
 		m_uVolt(new unsigned int[m_Columns] {}), m_vVolt(new unsigned int[m_Rows] {}),
 		m_Memos(new unsigned char[m_Columns * m_Rows] {}),
 		m_MemosTemp(new unsigned char[m_Columns * m_Rows] {}),
-		m_PossibilitiesTempIn(new unsigned char[max(m_Columns, m_Rows)] {}),
-		m_PossibilitiesTempOut(new unsigned char[max(m_Columns, m_Rows)] {}),
-		m_LookupTemp(new MEMO_TYPE[max(m_Columns, m_Rows)] {}),
+		m_MemosTempRows(new unsigned char[m_Columns * m_Rows] {}),
+		m_IsPlanesEnabled(BitBoard::Fits(m_Rows, m_Columns)), m_PlanesTemp(m_Rows, m_Columns),
+		m_Stats {}, m_CancelFlag(nullptr), m_GameLevel(0), m_OpeningBook(nullptr), m_IsHintsValid(false), m_LineTable(LineTable::Get()),
 		m_UserConf(new bool[m_Columns * m_Rows] {}),
-		m_LookupCounts(new unsigned int* [max(m_Columns, m_Rows)] {}),
-		m_Lookups(new MemoCounts** [max(m_Columns, m_Rows)] {}),
+		m_LookupArena(m_IsStaticLookup || !m_Columns || !m_Rows ? nullptr : new unsigned char[GetLookupArenaSize(max(m_Columns, m_Rows))]),
+		m_LookupOffsets(nullptr), m_LookupEntries(nullptr),
+		m_IsMemosStable(false), m_IsLineQueued(m_Columns + m_Rows),
 		m_LastUserColumn(-1), m_LastUserRow(-1), m_LastUserMemo(MEMO_1 | MEMO_2 | MEMO_3 | MEMO_VOLT)
 	{
+		m_Scratches.emplace_back(max(m_Columns, m_Rows));
+
 		if (columns > MAX_DIM || rows > MAX_DIM)
 			std::cout << "Maximum dimensions exceeded. Falling back to a size of " << MAX_DIM << "." << std::endl;
 
 		ResetMemos();
 
-		m_IsLookupInitialized = m_Columns && m_Rows && m_uPoint && m_vPoint && m_uVolt && m_vVolt && m_MemosTemp && m_Lookups
+		m_IsLookupInitialized = m_Columns && m_Rows && m_uPoint && m_vPoint && m_uVolt && m_vVolt && m_MemosTemp
 			&& CreateLookupArrays();
 	}
 
 	Solver::~Solver()
 	{
-		for (unsigned int i = 0; i < max(m_Columns, m_Rows); i++)
-		{
-			delete[] m_Lookups[i];
-		}
-		delete[] m_Lookups;
+		delete[] m_LookupArena;
 
 		delete[] m_UserConf;
 
+		delete[] m_MemosTempRows;
 		delete[] m_MemosTemp;
+		delete[] m_Memos;
 
 		delete[] m_vVolt;
 		delete[] m_uVolt;
@@ -72,8 +110,13 @@ namespace VF
 
 	unsigned char Solver::SetMemo(unsigned int column, unsigned int row, MEMO_TYPE memo)
 	{
-		m_Memos[column * m_Rows + row] = memo | MEMO_CONF;
-		m_UserConf[column * m_Rows + row] = true;
+		STAT_INC(m_Stats.userActions);
+
+		unsigned int field = column * m_Rows + row;
+		m_UserActions.push_back(UserAction { field, memo, m_UserConf[field], m_Trail.size(), false });
+
+		SetMemoTrailed(field, memo | MEMO_CONF);
+		m_UserConf[field] = true;
 
 		m_LastUserColumn = column;
 		m_LastUserRow = row;
@@ -86,13 +129,76 @@ namespace VF
 
 	unsigned char Solver::UnsetMemo(unsigned int column, unsigned int row)
 	{
-		m_Memos[column * m_Rows + row] = MEMO_1 | MEMO_2 | MEMO_3 | MEMO_VOLT;
-		m_UserConf[column * m_Rows + row] = false;
+		STAT_INC(m_Stats.userActions);
 
-		ResetMemos();
-		SolveUntilStable();
+		unsigned int field = column * m_Rows + row;
 
-		return m_Memos[column * m_Rows + row];
+		//	1. Find the user action that made the field user-confirmed.
+		size_t actionIdx = 0;
+		bool isTrailed = false;
+		if (m_UserConf[field])
+		{
+			for (size_t i = m_UserActions.size(); i-- > 0;)
+			{
+				if (m_UserActions[i].field == field)
+				{
+					actionIdx = i;
+					isTrailed = true;
+					break;
+				}
+			}
+		}
+
+		//	Memos deduced from an overwritten or a retracted user memo stay in the trail, and a solve from scratch would drop them.
+		//	Rolling back only gives the same memos without such actions.
+		for (size_t i = 0; isTrailed && i < m_UserActions.size(); i++)
+			isTrailed = !m_UserActions[i].wasUserConf && !m_UserActions[i].isRetracted;
+
+		if (!isTrailed)
+		{
+			//	The field was confirmed before the trail started (or is not confirmed at all), or the trail can not be rolled back, solve from scratch.
+			m_Memos[field] = MEMO_1 | MEMO_2 | MEMO_3 | MEMO_VOLT;
+			m_UserConf[field] = false;
+			STAT_INC(m_Stats.fullSolves);
+
+			ResetMemos();
+			SolveUntilStable();
+
+			return m_Memos[field];
+		}
+
+		//	2. Collect the later user actions that are still in effect, only the last action on each field counts.
+		std::vector<UserAction> replayActions;
+		std::vector<bool> isFieldReplayed(m_Columns * m_Rows);
+		for (size_t i = m_UserActions.size(); i-- > actionIdx + 1;)
+		{
+			const UserAction& action = m_UserActions[i];
+			if (action.field == field || !m_UserConf[action.field] || isFieldReplayed[action.field])
+				continue;
+
+			isFieldReplayed[action.field] = true;
+			replayActions.push_back(action);
+		}
+
+		//	3. Roll the memos and the user-confirmed flags back to before the action.
+		STAT_INC(m_Stats.rollbacks);
+		STAT_ADD(m_Stats.rolledBackMemos, m_Trail.size() - m_UserActions[actionIdx].trailStart);
+		while (m_Trail.size() > m_UserActions[actionIdx].trailStart)
+		{
+			m_Memos[m_Trail.back().field] = m_Trail.back().memo;
+			m_Trail.pop_back();
+		}
+		for (size_t i = m_UserActions.size(); i-- > actionIdx;)
+			m_UserConf[m_UserActions[i].field] = m_UserActions[i].wasUserConf;
+		m_UserActions.resize(actionIdx);
+
+		//	4. Replay the later user actions in their original order. The board before the action was already stable,
+		//	so each replay only propagates what its memo adds.
+		STAT_ADD(m_Stats.replayedActions, replayActions.size());
+		for (size_t i = replayActions.size(); i-- > 0;)
+			SetMemo(replayActions[i].field / m_Rows, replayActions[i].field % m_Rows, replayActions[i].memo);
+
+		return m_Memos[field];
 	}
 
 	bool Solver::IsMemoUserConfirmed(unsigned int column, unsigned int row) const
@@ -100,8 +206,21 @@ namespace VF
 		return m_UserConf[column * m_Rows + row];
 	}
 
+	void Solver::ResetBoard()
+	{
+		std::memset(m_UserConf, 0, sizeof(*m_UserConf) * m_Columns * m_Rows);
+
+		m_LastUserColumn = -1;
+		m_LastUserRow = -1;
+		m_LastUserMemo = MEMO_1 | MEMO_2 | MEMO_3 | MEMO_VOLT;
+
+		ResetMemos();
+	}
+
 	bool Solver::SetHints(const unsigned int* uPoint, const unsigned int* vPoint, const unsigned int* uVolt, const unsigned int* vVolt)
 	{
+		m_IsHintsValid = false;
+
 		for (unsigned int u = 0; u < m_Columns; u++)
 		{
 			if (uPoint[u] + uVolt[u] < m_Rows || uPoint[u] > (m_Rows - uVolt[u]) * 3)
@@ -132,152 +251,77 @@ namespace VF
 			return false;
 		}
 
+		m_IsHintsValid = true;
 		return true;
 	}
 
 	bool Solver::CreateLookupArrays()
 	{
-		if (m_LookupCounts && m_Lookups)
+		if (m_IsStaticLookup)
 		{
-			//	Iterate over all possible counts of missing fields
-			for (unsigned int i = 0; i < max(m_Columns, m_Rows); i++)
-			{
-				unsigned int missingFields = i + 1;	//	Count of fields that are unknown
-				unsigned int possibilities = SQUARE(missingFields + 1);	//	Count of all different possibilities at this count of unknown fields
-
-				//	Allocate array for arrays of all possibilities at specific count of missing fields
-				m_LookupCounts[i] = new unsigned int[possibilities] {};
-				m_Lookups[i] = new MemoCounts*[possibilities] {};
-				if (m_LookupCounts[i] == nullptr || m_Lookups[i] == nullptr)
-					return false;
-
-				unsigned int possIndex = 0;	//	Index into the array of possibilities
-				//	Iterate over all possible volt counts
-				for (unsigned int voltCount = 0; voltCount <= missingFields; voltCount++)
-				{
-					unsigned int pointFields = missingFields - voltCount;	// Count of missing fields that have points
+			m_LookupOffsets = STATIC_LOOKUP_TABLE.offsets;
+			m_LookupEntries = STATIC_LOOKUP_TABLE.entries;
+			return true;
+		}
 
-					unsigned char* points = new unsigned char[pointFields];	// Array with the points for each field
+		if (!m_LookupArena)
+			return false;
 
-					//	Iterate over all possible amounts of missing points
-					for (unsigned int missingPoints = pointFields * 1; missingPoints <= pointFields * 3; missingPoints++)	// Count of points that are missing across all unknown fields
-					{
-						unsigned int possibilityCount = min(missingPoints - pointFields * 1, pointFields * 3 - missingPoints) / 2 + 1;	// Count of different possibilities
-						m_LookupCounts[i][possIndex] = possibilityCount;
-						m_Lookups[i][possIndex] = new MemoCounts[possibilityCount] {};
-
-						for (unsigned int j = 0; j < possibilityCount; j++)
-							m_Lookups[i][possIndex][j].memoV = voltCount;
-
-						//	All fields start with value 1, giving the lowest possible total point count.
-						std::memset(points, 1, sizeof(*points) * pointFields);
-
-						unsigned int foundPossCount = 0;		// Count of how many different possibilities were already found
-						unsigned int pointTotal = pointFields;	// Count of points across all unknown fields for current attempt at finding valid possibilities
-						//	Iterate over all possible point distributions and take note of those possibilities that yield the correct amount of missing points.
-						while (true)
-						{
-							if (pointTotal < missingPoints)
-							{
-								//	If the point total is less than the amount of missing points, increase the first field from the back that has less than 3 points.
-								for (int j = pointFields - 1; j >= 0; j--)
-								{
-									if (points[j] == 3)
-										continue;
-									points[j]++;
-									break;
-								}
-							}
-
-							pointTotal = 0;
-							MemoCounts possibility { .memo1 = 0, .memo2 = 0, .memo3 = 0, .memoV = (unsigned char)voltCount };	// Possibility of unknown fields
-							//	Iterate over all fields to update the point total and take note which individual points are used in this arrangement.
-							for (unsigned int j = 0; j < pointFields; j++)
-							{
-								pointTotal += points[j];
-								switch (points[j])
-								{
-								case 1: possibility.memo1++; break;
-								case 2: possibility.memo2++; break;
-								case 3: possibility.memo3++; break;
-								}
-							}
-
-							//	If this point total is too low, continue to the next iteration which will increase the point count by 1.
-							if (pointTotal < missingPoints)
-								continue;
-
-							//	Having arrived here, we know we are in a configuration with the correct amount of points, so we include the possibility in the lookup.
-							//	This is done conservatively, meaning for example if this config no longer includes ones, but the previous one did, they are all kept.
-							//	In certain cases this leads to a weaker statement when solving than would be possible, and can be improved with a different lookup design.
-							m_Lookups[i][possIndex][foundPossCount] = possibility;
-							foundPossCount++;
-
-							//	Search for another possibility
-							bool foundNewPossibility = false;	//	Whether a new possibility was found this iteration.
-
-							//	We iterate over all offsets between pairs of 2 fields starting with all pairs of adjacent fields,
-							//	in search for a pair of fields that are more than 1 point apart, to redistribute the points,
-							//	i.e. (MEMO_1, MEMO_3) --> (MEMO_2, MEMO_2).
-							for (unsigned int indexOffset = 1; indexOffset < pointFields; indexOffset++)	// Offset between indices of fields which will be compared
-							{
-								//	Since the lowest field values are in the front, we start with pairs where the larger field is in the back.
-								for (int j = pointFields - 1; j > indexOffset - 1; j--)	//	Index of field which will be compared against field at this index minus the indexOffset
-								{
-									//	If the field further back is larger by more than 1, decrement its points and increment the other's.
-									if (points[j] > points[j - indexOffset] + 1)
-									{
-										points[j]--;
-										points[j - indexOffset]++;
-										foundNewPossibility = true;
-										break;
-									}
-								}
-								if (foundNewPossibility)
-									break;
-							}
-							if (!foundNewPossibility)
-								break;
-						}
+		//	The offsets of all slots come first, the entries follow right after them in the same allocation.
+		unsigned int maxFields = max(m_Columns, m_Rows);
+		unsigned int slotCount = GetLookupSlotBase(maxFields + 1);
+		unsigned int entryCount = GetLookupEntryCount(maxFields);
 
-#ifdef _DEBUG
-						std::cout <<
-							"missingFields: " << std::setw(3) << missingFields <<
-							", voltCount: " << std::setw(3) << voltCount <<
-							", missingPoints: " << std::setw(3) << missingPoints <<
-							", possibilityCount: " << std::setw(3) << possibilityCount <<
-							", lookup:";
-						for (unsigned int j = 0; j < possibilityCount; j++)
-						{
-							for (unsigned int j1 = 0; j1 < m_Lookups[i][possIndex][j].memo1; j1++)
-								std::cout << " 1";
-							for (unsigned int j2 = 0; j2 < m_Lookups[i][possIndex][j].memo2; j2++)
-								std::cout << " 2";
-							for (unsigned int j3 = 0; j3 < m_Lookups[i][possIndex][j].memo3; j3++)
-								std::cout << " 3";
-							for (unsigned int jV = 0; jV < voltCount; jV++)
-								std::cout << " V";
-							if (j + 1 < possibilityCount)
-								std::cout << ",";
-						}
-						std::cout << std::endl;
-#endif
+		unsigned int* offsets = new (m_LookupArena) unsigned int[slotCount + 1];
+		MemoCounts* entries = new (m_LookupArena + sizeof(unsigned int) * (slotCount + 1)) MemoCounts[entryCount];
+		FillLookupTable(maxFields, offsets, entries);
 
-						possIndex++;
-					}
+		m_LookupOffsets = offsets;
+		m_LookupEntries = entries;
 
-					delete[] points;
+#ifdef _DEBUG
+		for (unsigned int missingFields = 1; missingFields <= maxFields; missingFields++)
+		{
+			for (unsigned int voltCount = 0; voltCount <= missingFields; voltCount++)
+			{
+				unsigned int pointFields = missingFields - voltCount;
+				for (unsigned int missingPoints = pointFields * 1; missingPoints <= pointFields * 3; missingPoints++)
+				{
+					unsigned int slot = GetLookupSlot(missingFields, voltCount, missingPoints);
+					unsigned int possibilityCount = offsets[slot + 1] - offsets[slot];
+					std::cout <<
+						"missingFields: " << std::setw(3) << missingFields <<
+						", voltCount: " << std::setw(3) << voltCount <<
+						", missingPoints: " << std::setw(3) << missingPoints <<
+						", possibilityCount: " << std::setw(3) << possibilityCount <<
+						", lookup:";
+					for (unsigned int j = offsets[slot]; j < offsets[slot + 1]; j++)
+					{
+						for (unsigned int j1 = 0; j1 < entries[j].memo1; j1++)
+							std::cout << " 1";
+						for (unsigned int j2 = 0; j2 < entries[j].memo2; j2++)
+							std::cout << " 2";
+						for (unsigned int j3 = 0; j3 < entries[j].memo3; j3++)
+							std::cout << " 3";
+						for (unsigned int jV = 0; jV < voltCount; jV++)
+							std::cout << " V";
+						if (j + 1 < offsets[slot + 1])
+							std::cout << ",";
+					}
+					std::cout << std::endl;
 				}
 			}
-
-			return true;
 		}
+#endif
 
-		return false;
+		return true;
 	}
 
 	void Solver::ResetMemos()
 	{
+		ClearTrail();
+		m_IsMemosStable = false;
+
 		for (unsigned int u = 0; u < m_Columns; u++)
 		{
 			for (unsigned int v = 0; v < m_Rows; v++)
@@ -285,7 +329,7 @@ namespace VF
 				if (!m_UserConf[u * m_Rows + v])
 				{
 					m_Memos[u * m_Rows + v] = MEMO_1 | MEMO_2 | MEMO_3 | MEMO_VOLT;
-					m_MemosTemp[u * m_Rows + v] = MEMO_1 | MEMO_2 | MEMO_3 | MEMO_VOLT;
+					SetMemoTemp(u, v, MEMO_1 | MEMO_2 | MEMO_3 | MEMO_VOLT);
 				}
 			}
 		}
@@ -294,29 +338,66 @@ namespace VF
 	void Solver::SolveUntilStable()
 	{
 		//	Copy the current legal solution into the temporary solution storage.
-		memcpy(m_MemosTemp, m_Memos, sizeof(*m_MemosTemp) * m_Columns * m_Rows);
+		LoadMemosTemp();
+
+		//	If the legal solution is stable, only the lines crossing the last user memo can change.
+		ClearQueue();
+		if (m_IsMemosStable && m_LastUserColumn < m_Columns && m_LastUserRow < m_Rows)
+		{
+			QueueLine(m_LastUserColumn, true);
+			QueueLine(m_LastUserRow, false);
+		}
+		else
+		{
+			QueueAllLines();
+		}
 
-		//	Repeatedly call SolveAll() and handle the return value.
+		//	Repeatedly call SolveQueued() and handle the return value.
+		bool isRetracted = false;
 		while (true)
 		{
-			switch (SolveAll())
+			STAT_INC(m_Stats.solveRounds);
+			switch (SolveQueued())
 			{
 			case SOLVE_NO_CHANGE:
+			case SOLVE_CHANGED:
 				CommitTemporarySolution();
+				m_IsMemosStable = true;
+				break;
+			case SOLVE_CANCELLED:
+				//	Keep the last committed memos, they are still sound. Since they are not stable, the next solve queues every line.
+				STAT_INC(m_Stats.cancellations);
+				m_IsMemosStable = false;
 				break;
-			case SOLVE_CHANGED:
-				continue;
 			case SOLVE_CONTRADICTION:
-				if (m_LastUserColumn != -1 && m_LastUserRow != -1 && m_LastUserMemo != MEMO_CONF)
+				STAT_INC(m_Stats.contradictions);
+				if (!isRetracted && m_LastUserColumn < m_Columns && m_LastUserRow < m_Rows && m_LastUserMemo != MEMO_CONF)
 				{
+					STAT_INC(m_Stats.retractions);
+					isRetracted = true;
+					if (!m_UserActions.empty())
+						m_UserActions.back().isRetracted = true;
+
 					//	Reset the memos to what they were before, minus the contradictory option selected by the user.
-					memcpy(m_MemosTemp, m_Memos, sizeof(*m_MemosTemp) * m_Columns * m_Rows);
-					m_MemosTemp[m_LastUserColumn * m_Rows + m_LastUserRow] = (MEMO_1 | MEMO_2 | MEMO_3 | MEMO_VOLT) ^ m_LastUserMemo;
+					LoadMemosTemp();
+					SetMemoTemp(m_LastUserColumn, m_LastUserRow, (MEMO_1 | MEMO_2 | MEMO_3 | MEMO_VOLT) ^ m_LastUserMemo);
 					m_UserConf[m_LastUserColumn * m_Rows + m_LastUserRow] = false;
+
+					ClearQueue();
+					if (m_IsMemosStable)
+					{
+						QueueLine(m_LastUserColumn, true);
+						QueueLine(m_LastUserRow, false);
+					}
+					else
+					{
+						QueueAllLines();
+					}
 				}
 				else
 				{
 					//	A contradiction before even a single button was clicked means the board is not solvable.
+					//	If withdrawing the user memo contradicts as well, the memos stay as they were.
 					break;
 				}
 				continue;
@@ -326,88 +407,248 @@ namespace VF
 		}
 	}
 
-	bool Solver::SolveLookupRecurse(unsigned int level, unsigned int elemCount)
+	Solver::LineScratch::LineScratch(unsigned int maxFields)
+		: possibilitiesIn(maxFields), possibilitiesOut(maxFields), lineCache(LINE_CACHE_CAPACITY), isCacheEnabled(true), stats {}
 	{
-		bool foundLegalSolution = false;
+	}
+
+	void Solver::SetThreadCount(unsigned int threadCount)
+	{
+		threadCount = max(threadCount, 1U);
 
-		for (unsigned int j = 0; j < level; j++)
+		m_Pool.reset();
+		if (threadCount > 1)
+			m_Pool = std::make_unique<WorkerPool>(threadCount);
+
+		while (m_Scratches.size() < threadCount)
+			m_Scratches.emplace_back(max(m_Columns, m_Rows));
+		m_Scratches.erase(m_Scratches.begin() + threadCount, m_Scratches.end());
+	}
+
+	void Solver::SetCancelFlag(const std::atomic<bool>* isCancelled)
+	{
+		m_CancelFlag = isCancelled;
+	}
+
+	bool Solver::SolveSingleLine(unsigned int index, bool isColumn, bool isCacheEnabled)
+	{
+		if (!m_IsLookupInitialized || index >= (isColumn ? m_Columns : m_Rows))
+			return false;
+
+		//	Only the fields of this line are read, the rest of the temporary solution is reloaded by the next SolveUntilStable().
+		for (unsigned int i = 0; i < (isColumn ? m_Rows : m_Columns); i++)
 		{
-			if(level > 2)
-				foundLegalSolution |= SolveLookupRecurse(level - 1, elemCount);
-			else
+			unsigned int column = isColumn ? index : i;
+			unsigned int row = isColumn ? i : index;
+			unsigned int field = column * m_Rows + row;
+			SetMemoTemp(column, row, m_UserConf[field] ? m_Memos[field] : (MEMO_1 | MEMO_2 | MEMO_3 | MEMO_VOLT));
+		}
+
+		LineScratch& scratch = m_Scratches[0];
+		scratch.changed.clear();
+		scratch.isCacheEnabled = isCacheEnabled;
+		SOLVE_RESULT result = SolveFields(index, isColumn, scratch);
+		scratch.isCacheEnabled = true;
+
+		return result != SOLVE_CONTRADICTION;
+	}
+
+	bool Solver::SolveLookup(const MemoCounts& memoCounts, unsigned int fieldCount, LineScratch& scratch) const
+	{
+		//	Instead of enumerating every permutation of the lookup, do a forward/backward pass over the states (ones, twos, threes placed so far),
+		//	the count of volts placed so far follows from the field index. A field can be of a type if a state reachable from the front
+		//	leads via that type into a state from which the back can still be completed. This is polynomial in the field count.
+		unsigned int threesStride = 1;
+		unsigned int twosStride = (memoCounts.memo3 + 1) * threesStride;
+		unsigned int onesStride = (memoCounts.memo2 + 1) * twosStride;
+		unsigned int stateCount = (memoCounts.memo1 + 1) * onesStride;
+
+		//	Reachability of every state from the front for each field index, followed by two layers of reachability from the back.
+		size_t reachSize = (size_t)(fieldCount + 3) * stateCount;
+		if (scratch.lookupReach.size() < reachSize)
+			scratch.lookupReach.resize(reachSize);
+
+		unsigned char* const forward = scratch.lookupReach.data();
+		unsigned char* backward = forward + (fieldCount + 1) * stateCount;
+		unsigned char* backwardNext = backward + stateCount;
+
+		//	1. Forward pass
+		std::memset(forward, 0, sizeof(*forward) * (fieldCount + 1) * stateCount);
+		forward[0] = 1;
+
+		for (unsigned int i = 0; i < fieldCount; i++)
+		{
+			const unsigned char* layer = forward + i * stateCount;
+			unsigned char* nextLayer = forward + (i + 1) * stateCount;
+			unsigned char memo = scratch.possibilitiesIn[i];
+
+			for (unsigned int ones = 0; ones <= memoCounts.memo1; ones++)
 			{
-				//	level == 1
-				bool isLegal = true;
-				for (unsigned int j = 0; j < elemCount; j++)
+				for (unsigned int twos = 0; twos <= memoCounts.memo2; twos++)
 				{
-					if (!(m_PossibilitiesTempIn[j] & m_LookupTemp[j]))
+					for (unsigned int threes = 0; threes <= memoCounts.memo3; threes++)
 					{
-						isLegal = false;
-#ifdef _DEBUG
-						break;
+						unsigned int state = ones * onesStride + twos * twosStride + threes * threesStride;
+						if (!layer[state])
+							continue;
+
+						unsigned int volts = i - ones - twos - threes;
+						if ((memo & MEMO_1) && ones < memoCounts.memo1)
+							nextLayer[state + onesStride] = 1;
+						if ((memo & MEMO_2) && twos < memoCounts.memo2)
+							nextLayer[state + twosStride] = 1;
+						if ((memo & MEMO_3) && threes < memoCounts.memo3)
+							nextLayer[state + threesStride] = 1;
+						if ((memo & MEMO_VOLT) && volts < memoCounts.memoV)
+							nextLayer[state] = 1;
 					}
-					else
-						isLegal = isLegal;
-				}
-#else
-					}
-					std::cout << (
-						(m_LookupTemp[j] & MEMO_1) ? " 1" : (
-							(m_LookupTemp[j] & MEMO_2) ? " 2" : (
-								(m_LookupTemp[j] & MEMO_3) ? " 3" : (
-									(m_LookupTemp[j] & MEMO_VOLT) ? " V" : " U"))));
 				}
-				std::cout << std::endl;
-#endif
+			}
+		}
 
-				if (isLegal)
-				{
-					for (unsigned int j = 0; j < elemCount; j++)
-						m_PossibilitiesTempOut[j] |= m_LookupTemp[j];
+		//	If the state with every field placed can not be reached, there is no legal arrangement of this lookup.
+		if (!forward[fieldCount * stateCount + stateCount - 1])
+			return false;
 
-					foundLegalSolution = true;
-				}
-			}
+		//	2. Backward pass, only states reachable from the front are of interest.
+		std::memset(backwardNext, 0, sizeof(*backwardNext) * stateCount);
+		backwardNext[stateCount - 1] = 1;
 
-			if (j > 0)
-			{
-				//	Undo previous iteration's swap
-				MEMO_TYPE lastLookup = m_LookupTemp[level - 1];
-				m_LookupTemp[level - 1] = m_LookupTemp[level - 1 - j];
-				m_LookupTemp[level - 1 - j] = lastLookup;
-			}
-			if (j + 1 < level)
+		for (int i = fieldCount - 1; i >= 0; i--)
+		{
+			const unsigned char* layer = forward + i * stateCount;
+			unsigned char memo = scratch.possibilitiesIn[i];
+			unsigned char legalMemo = 0;
+
+			std::memset(backward, 0, sizeof(*backward) * stateCount);
+
+			for (unsigned int ones = 0; ones <= memoCounts.memo1; ones++)
 			{
-				//	Swap a new lookup with the last one at this level
-				MEMO_TYPE lastLookup = m_LookupTemp[level - 1];
-				m_LookupTemp[level - 1] = m_LookupTemp[level - 1 - (j + 1)];
-				m_LookupTemp[level - 1 - (j + 1)] = lastLookup;
+				for (unsigned int twos = 0; twos <= memoCounts.memo2; twos++)
+				{
+					for (unsigned int threes = 0; threes <= memoCounts.memo3; threes++)
+					{
+						unsigned int state = ones * onesStride + twos * twosStride + threes * threesStride;
+						if (!layer[state])
+							continue;
+
+						unsigned int volts = i - ones - twos - threes;
+						unsigned char stateMemo = 0;
+						if ((memo & MEMO_1) && ones < memoCounts.memo1 && backwardNext[state + onesStride])
+							stateMemo |= MEMO_1;
+						if ((memo & MEMO_2) && twos < memoCounts.memo2 && backwardNext[state + twosStride])
+							stateMemo |= MEMO_2;
+						if ((memo & MEMO_3) && threes < memoCounts.memo3 && backwardNext[state + threesStride])
+							stateMemo |= MEMO_3;
+						if ((memo & MEMO_VOLT) && volts < memoCounts.memoV && backwardNext[state])
+							stateMemo |= MEMO_VOLT;
+
+						backward[state] = stateMemo != 0;
+						legalMemo |= stateMemo;
+					}
+				}
 			}
+
+			scratch.possibilitiesOut[i] |= legalMemo;
+
+			unsigned char* swap = backward;
+			backward = backwardNext;
+			backwardNext = swap;
+		}
+
+		return true;
+	}
+
+	bool Solver::SolveLine(unsigned int missingFields, unsigned int missingPoints, unsigned int missingVolts, LineScratch& scratch) const
+	{
+		if (missingFields <= LineTable::MAX_FIELDS)
+		{
+			STAT_INC(scratch.stats.tableFilters);
+			uint32_t legal = m_LineTable.Solve(GetLookupSlot(missingFields, missingVolts, missingPoints), LineTable::Pack(scratch.possibilitiesIn.data(), missingFields));
+			for (unsigned int i = 0; i < missingFields; i++)
+				scratch.possibilitiesOut[i] = (legal >> (4 * i)) & 0x0F;
+			return legal != 0;
 		}
 
+		//	Do lookup of possibilities
+		const unsigned int* offsets = m_LookupOffsets + GetLookupSlot(missingFields, missingVolts, missingPoints);
+		const MemoCounts* lookups = m_LookupEntries + offsets[0];	// Different possibilities in this lookup
+		unsigned int lookupCount = offsets[1] - offsets[0];			// Count of different possibilities in this lookup
+		STAT_ADD(scratch.stats.lookupEntries, lookupCount);
+
+		bool foundLegalSolution = false;
+		for (unsigned int lookupIdx = 0; lookupIdx < lookupCount; lookupIdx++)
+			foundLegalSolution |= SolveLookup(lookups[lookupIdx], missingFields, scratch);
 		return foundLegalSolution;
 	}
 
 	Solver::SOLVE_RESULT Solver::Solve(unsigned int index, bool isColumn)
 	{
+		LineScratch& scratch = m_Scratches[0];
+		scratch.changed.clear();
+
+		SOLVE_RESULT result = SolveFields(index, isColumn, scratch);
+		if (result == SOLVE_CONTRADICTION)
+			return SOLVE_CONTRADICTION;
+
+		//	The lines crossing changed fields have to be solved again.
+		for (unsigned int i : scratch.changed)
+			QueueLine(i, !isColumn);
+
+		if (m_IsPlanesEnabled)
+		{
+			//	Confirm all fields with exactly one type left in a few word operations.
+			for (uint64_t singles = m_PlanesTemp.ConfirmSingles(); singles; singles &= singles - 1)
+			{
+				unsigned int field = std::countr_zero(singles);
+				m_MemosTemp[field] |= MEMO_CONF;
+				m_MemosTempRows[(field % m_Rows) * m_Columns + field / m_Rows] |= MEMO_CONF;
+				result = SOLVE_CHANGED;
+
+				QueueLine(field / m_Rows, true);
+				QueueLine(field % m_Rows, false);
+			}
+		}
+
+#ifdef _DEBUG
+		PrintBoard();
+#endif
+
+		return result;
+	}
+
+	Solver::SOLVE_RESULT Solver::SolveFields(unsigned int index, bool isColumn, LineScratch& scratch)
+	{
+		STAT_INC(scratch.stats.lineSolves);
+
 		bool isAnythingChanged = false;
 
 		unsigned int confFieldCount = 0;
 		unsigned int confPointCount = 0;
 		unsigned int confVoltCount = 0;
 
-		unsigned int poss1Count = 0;
-		unsigned int poss2Count = 0;
-		unsigned int poss3Count = 0;
-		unsigned int possVoltCount = 0;
+		//	1.1 Check how much of each type is already confirmed in this line, with masked popcounts if the board fits into bitplanes.
+		if (m_IsPlanesEnabled)
+		{
+			BitBoard::LineCounts counts = m_PlanesTemp.GetLineCounts(index, isColumn);
+			confFieldCount = counts.confFieldCount;
+			confPointCount = counts.confPointCount;
+			confVoltCount = counts.confVoltCount;
+		}
+
+		//	Both orders are stored, so the fields of a column or row are contiguous either way.
+		const unsigned char* line = isColumn ? (m_MemosTemp + index * m_Rows) : (m_MemosTempRows + index * m_Columns);
 
-		//	1.1 Check how much of each type is already confirmed/still possible in this column.
+		unsigned int missingFields = 0;
 		for (unsigned int i = 0; i < (isColumn ? m_Rows : m_Columns); i++)
 		{
-			unsigned int memo = m_MemosTemp[isColumn ? (index * m_Rows + i) : (i * m_Columns + index)];
+			unsigned int memo = line[i];
 
 			if (memo & MEMO_CONF)
 			{
+				if (m_IsPlanesEnabled)
+					continue;
+
 				//	1.1a If this field is already confirmed, take note what it is.
 				confFieldCount++;
 
@@ -430,65 +671,43 @@ namespace VF
 			else
 			{
 				//	1.1b If this field is still unconfirmed, take note of what it can still be.
-				if (memo & MEMO_1)
-					poss1Count++;
-				if (memo & MEMO_2)
-					poss2Count++;
-				if (memo & MEMO_3)
-					poss3Count++;
-				if (memo & MEMO_VOLT)
-					possVoltCount++;
-
-				m_PossibilitiesTempIn[i - confFieldCount] = memo;
-				m_PossibilitiesTempOut[i - confFieldCount] = 0;
+				scratch.possibilitiesIn[missingFields] = memo;
+				scratch.possibilitiesOut[missingFields] = 0;
+				missingFields++;
 			}
 		}
 
-		unsigned int missingFields = (isColumn ? m_Rows : m_Columns) - confFieldCount;
+		//	A line without unconfirmed fields can not change, but its confirmed fields still have to match the hints.
 		if (missingFields == 0)
-			return SOLVE_NO_CHANGE;
+		{
+			bool isLegal = confPointCount == (isColumn ? m_uPoint : m_vPoint)[index] && confVoltCount == (isColumn ? m_uVolt : m_vVolt)[index];
+			return isLegal ? SOLVE_NO_CHANGE : SOLVE_CONTRADICTION;
+		}
 
 		int missingPoints = (isColumn ? m_uPoint : m_vPoint)[index] - confPointCount;
 		int missingVolts = (isColumn ? m_uVolt : m_vVolt)[index] - confVoltCount;
 
 		if (missingPoints < 0 ||
 			missingVolts < 0 ||
-			missingPoints > (missingFields - missingVolts) * 3 ||
-			missingPoints < (missingFields - missingVolts) * 1
+			missingVolts > (int)missingFields ||
+			missingPoints > ((int)missingFields - missingVolts) * 3 ||
+			missingPoints < ((int)missingFields - missingVolts) * 1
 		)
 			return SOLVE_CONTRADICTION;
 
 
-		//	1.2 Do lookup of possibilities
-		int possIndex = 0;	//	Index into the array of possibilities
-		for (unsigned int voltCount = 0; voltCount < missingVolts; voltCount++)
-		{
-			unsigned int pointFields = missingFields - voltCount;
-			possIndex += pointFields * 3 - pointFields * 1 + 1;
-		}
-		possIndex += missingPoints - (missingFields - missingVolts) * 1;
-
-		if (possIndex < 0)
-			return SOLVE_CONTRADICTION;
-
-		unsigned int lookupCount = m_LookupCounts[missingFields - 1][possIndex];	// Count of different possibilities in this lookup
+		//	1.2 Solve the line, or take the result from the cache if the same situation was solved before.
+		LineCache::Key cacheKey;
+		bool isCacheable = scratch.isCacheEnabled && LineCache::MakeKey(scratch.possibilitiesIn.data(), missingFields, missingPoints, missingVolts, cacheKey);
 
-		bool foundLegalSolution = false;
-		for (unsigned int lookupIdx = 0; lookupIdx < lookupCount; lookupIdx++)
+		bool isLegal;
+		if (!isCacheable || !scratch.lineCache.Find(cacheKey, scratch.possibilitiesIn.data(), missingFields, scratch.possibilitiesOut.data(), isLegal))
 		{
-			MemoCounts memoCounts = m_Lookups[missingFields - 1][possIndex][lookupIdx];
-			for (unsigned int onesIdx = 0; onesIdx < memoCounts.memo1; onesIdx++)
-				m_LookupTemp[onesIdx] = MEMO_1;
-			for (unsigned int twosIdx = memoCounts.memo1; twosIdx < memoCounts.memo1 + memoCounts.memo2; twosIdx++)
-				m_LookupTemp[twosIdx] = MEMO_2;
-			for (unsigned int threesIdx = memoCounts.memo1 + memoCounts.memo2; threesIdx < memoCounts.memo1 + memoCounts.memo2 + memoCounts.memo3; threesIdx++)
-				m_LookupTemp[threesIdx] = MEMO_3;
-			for (unsigned int voltsIdx = memoCounts.memo1 + memoCounts.memo2 + memoCounts.memo3; voltsIdx < memoCounts.memo1 + memoCounts.memo2 + memoCounts.memo3 + memoCounts.memoV; voltsIdx++)
-				m_LookupTemp[voltsIdx] = MEMO_VOLT;
-
-			foundLegalSolution |= SolveLookupRecurse(missingFields, missingFields);
+			isLegal = SolveLine(missingFields, missingPoints, missingVolts, scratch);
+			if (isCacheable)
+				scratch.lineCache.Insert(cacheKey, scratch.possibilitiesIn.data(), missingFields, scratch.possibilitiesOut.data(), isLegal);
 		}
-		if (!foundLegalSolution)
+		if (!isLegal)
 			return SOLVE_CONTRADICTION;
 
 
@@ -496,77 +715,476 @@ namespace VF
 		unsigned int confMemos = 0;
 		for (unsigned int i = 0; i < (isColumn ? m_Rows : m_Columns); i++)
 		{
-			unsigned char memo = m_MemosTemp[isColumn ? (index * m_Rows + i) : (i * m_Columns + index)];
+			unsigned char memo = line[i];
 			if (memo & MEMO_CONF)
 			{
 				confMemos++;
 				continue;
 			}
 
-			memo &= m_PossibilitiesTempOut[i - confMemos];
+			memo &= scratch.possibilitiesOut[i - confMemos];
 
 			if (!(memo & (MEMO_1 | MEMO_2 | MEMO_3 | MEMO_VOLT)))
 				return SOLVE_CONTRADICTION;
 
-			//	Check if exactly one type is possible -> confirmed field
-			if ((memo ^ MEMO_1) == 0 || (memo ^ MEMO_2) == 0 || (memo ^ MEMO_3) == 0 || (memo ^ MEMO_VOLT) == 0)
+			//	Check if exactly one type is possible -> confirmed field (done for the whole board at once below if bitplanes are used)
+			if (!m_IsPlanesEnabled && ((memo ^ MEMO_1) == 0 || (memo ^ MEMO_2) == 0 || (memo ^ MEMO_3) == 0 || (memo ^ MEMO_VOLT) == 0))
 				memo |= MEMO_CONF;
 
-			if (memo != m_MemosTemp[isColumn ? (index * m_Rows + i) : (i * m_Columns + index)])
+			if (memo != line[i])
 			{
-				m_MemosTemp[isColumn ? (index * m_Rows + i) : (i * m_Columns + index)] = memo;
+				SetMemoTemp(isColumn ? index : i, isColumn ? i : index, memo);
 				isAnythingChanged = true;
+				scratch.changed.push_back(i);
 			}
 		}
 
-#ifdef _DEBUG
-		PrintBoard();
-#endif
-
 		return isAnythingChanged ? SOLVE_CHANGED : SOLVE_NO_CHANGE;
 	}
 
-	Solver::SOLVE_RESULT Solver::SolveAll()
+	Solver::SOLVE_RESULT Solver::SolveQueued()
 	{
-		bool isAnythingChanged = false;
+		if (IsParallel())
+			return SolveQueuedParallel();
 
-		//	1. Iterate over all columns.
-		for (unsigned int u = 0; u < m_Columns; u++)
+		while (!m_LineQueue.empty())
 		{
-			switch (Solve(u, true))
-			{
-			case SOLVE_NO_CHANGE:
-				break;
-			case SOLVE_CHANGED:
-				isAnythingChanged = true;
-				break;
-			case SOLVE_CONTRADICTION:
+			if (IsCancelled())
+				return SOLVE_CANCELLED;
+
+			unsigned int line = (unsigned int)m_LineQueue.top();
+			m_LineQueue.pop();
+			m_IsLineQueued[line] = false;
+
+			bool isColumn = line < m_Columns;
+			if (Solve(isColumn ? line : line - m_Columns, isColumn) == SOLVE_CONTRADICTION)
 				return SOLVE_CONTRADICTION;
+		}
+
+		return SOLVE_NO_CHANGE;
+	}
+
+	Solver::SOLVE_RESULT Solver::SolveQueuedParallel()
+	{
+		std::atomic<bool> isContradiction = false;
+		WorkerPool::Task task = [this, &isContradiction](unsigned int index, unsigned int worker)
+		{
+			if (isContradiction)
+				return;
+
+			unsigned int line = m_PhaseLines[index];
+			bool isColumn = line < m_Columns;
+			if (SolveFields(isColumn ? line : line - m_Columns, isColumn, m_Scratches[worker]) == SOLVE_CONTRADICTION)
+				isContradiction = true;
+		};
+
+		//	Alternate between solving every queued column and every queued row. The lines of one phase share no field, so they are solved
+		//	at the same time. The lines queued by a phase only depend on which fields changed, not on the order of the lines, and the fixpoint
+		//	of the narrowing is unique, so the result is the same as with the serial engine.
+		bool isAnyLineSolved = true;
+		while (isAnyLineSolved)
+		{
+			isAnyLineSolved = false;
+			for (bool isColumn : { true, false })
+			{
+				m_PhaseLines.clear();
+				for (unsigned int line = isColumn ? 0 : m_Columns; line < (isColumn ? m_Columns : m_Columns + m_Rows); line++)
+				{
+					if (m_IsLineQueued[line])
+					{
+						m_IsLineQueued[line] = false;
+						m_PhaseLines.push_back(line);
+					}
+				}
+				if (m_PhaseLines.empty())
+					continue;
+
+				if (IsCancelled())
+					return SOLVE_CANCELLED;
+
+				isAnyLineSolved = true;
+				for (LineScratch& scratch : m_Scratches)
+					scratch.changed.clear();
+
+				m_Pool->Run((unsigned int)m_PhaseLines.size(), task);
+				if (isContradiction)
+					return SOLVE_CONTRADICTION;
+
+				//	Queue the lines crossing the changed fields of every worker.
+				for (const LineScratch& scratch : m_Scratches)
+				{
+					for (unsigned int i : scratch.changed)
+						m_IsLineQueued[isColumn ? m_Columns + i : i] = true;
+				}
 			}
 		}
 
-		//	2. Iterate over all rows
+		return SOLVE_NO_CHANGE;
+	}
+
+	bool Solver::IsCancelled() const
+	{
+		return m_CancelFlag && m_CancelFlag->load(std::memory_order_relaxed);
+	}
+
+	bool Solver::IsParallel() const
+	{
+		return m_Pool && m_Columns >= PARALLEL_MIN_DIM && m_Rows >= PARALLEL_MIN_DIM;
+	}
+
+	void Solver::QueueLine(unsigned int index, bool isColumn)
+	{
+		unsigned int line = isColumn ? index : m_Columns + index;
+		if (m_IsLineQueued[line])
+			return;
+
+		m_IsLineQueued[line] = true;
+
+		//	The parallel engine takes whole phases of lines from m_IsLineQueued, in no particular order.
+		if (IsParallel())
+			return;
+
+		m_LineQueue.push(((uint64_t)GetMissingFieldCount(index, isColumn) << 32) | line);
+	}
+
+	void Solver::QueueAllLines()
+	{
+		for (unsigned int u = 0; u < m_Columns; u++)
+			QueueLine(u, true);
+		for (unsigned int v = 0; v < m_Rows; v++)
+			QueueLine(v, false);
+	}
+
+	void Solver::ClearQueue()
+	{
+		while (!m_LineQueue.empty())
+			m_LineQueue.pop();
+		std::fill(m_IsLineQueued.begin(), m_IsLineQueued.end(), false);
+	}
+
+	unsigned int Solver::GetMissingFieldCount(unsigned int index, bool isColumn) const
+	{
+		if (m_IsPlanesEnabled)
+			return std::popcount(~m_PlanesTemp.GetPlane(BitBoard::PLANE_CONF) & m_PlanesTemp.GetLineMask(index, isColumn));
+
+		const unsigned char* line = isColumn ? (m_MemosTemp + index * m_Rows) : (m_MemosTempRows + index * m_Columns);
+
+		unsigned int missingFields = 0;
+		for (unsigned int i = 0; i < (isColumn ? m_Rows : m_Columns); i++)
+		{
+			if (!(line[i] & MEMO_CONF))
+				missingFields++;
+		}
+		return missingFields;
+	}
+
+	void Solver::SetMemoTemp(unsigned int column, unsigned int row, unsigned char memo)
+	{
+		m_MemosTemp[column * m_Rows + row] = memo;
+		m_MemosTempRows[row * m_Columns + column] = memo;
+		if (m_IsPlanesEnabled)
+			m_PlanesTemp.SetMemo(column * m_Rows + row, memo);
+	}
+
+	void Solver::LoadMemosTemp()
+	{
+		memcpy(m_MemosTemp, m_Memos, sizeof(*m_MemosTemp) * m_Columns * m_Rows);
+		for (unsigned int u = 0; u < m_Columns; u++)
+		{
+			for (unsigned int v = 0; v < m_Rows; v++)
+				m_MemosTempRows[v * m_Columns + u] = m_Memos[u * m_Rows + v];
+		}
+
+		if (m_IsPlanesEnabled)
+			m_PlanesTemp.Load(m_MemosTemp);
+	}
+
+	void Solver::CommitTemporarySolution()
+	{
+		if (m_UserActions.empty())
+		{
+			if (m_Columns && m_Rows)
+				memcpy(m_Memos, m_MemosTemp, sizeof(*m_Memos) * m_Columns * m_Rows);
+			return;
+		}
+
+		for (unsigned int i = 0; i < m_Columns * m_Rows; i++)
+		{
+			if (m_Memos[i] != m_MemosTemp[i])
+				SetMemoTrailed(i, m_MemosTemp[i]);
+		}
+	}
+
+	void Solver::SetMemoTrailed(unsigned int field, unsigned char memo)
+	{
+		//	Before the first user action there is nothing to roll back to.
+		if (!m_UserActions.empty())
+			m_Trail.push_back(TrailEntry { field, m_Memos[field] });
+		m_Memos[field] = memo;
+	}
+
+	void Solver::ClearTrail()
+	{
+		m_Trail.clear();
+		m_UserActions.clear();
+	}
+
+	//	BoardRecord::MAX_DIM, which the MAX_DIM of the solver hides in this file.
+	static constexpr unsigned int RECORD_MAX_DIM = sizeof(BoardRecord::uPoint);
+
+	bool Solver::SaveRecord(BoardRecord& record) const
+	{
+		if (!BoardRecord::Fits(m_Rows, m_Columns))
+			return false;
+
+		record = BoardRecord {};
+		record.rows = (uint8_t)m_Rows;
+		record.columns = (uint8_t)m_Columns;
+		record.flags = m_IsHintsValid ? BoardRecord::RECORD_VALID : 0;
+
+		for (unsigned int u = 0; u < m_Columns; u++)
+		{
+			record.uPoint[u] = (uint8_t)m_uPoint[u];
+			record.uVolt[u] = (uint8_t)m_uVolt[u];
+		}
+		for (unsigned int v = 0; v < m_Rows; v++)
+		{
+			record.vPoint[v] = (uint8_t)m_vPoint[v];
+			record.vVolt[v] = (uint8_t)m_vVolt[v];
+		}
+
+		for (unsigned int field = 0; field < m_Columns * m_Rows; field++)
+		{
+			record.memos[field] = m_Memos[field];
+			if (m_UserConf[field])
+				record.userConf |= 1ULL << field;
+		}
+
+		return true;
+	}
+
+	bool Solver::LoadRecord(const BoardRecord& record)
+	{
+		if (record.rows != m_Rows || record.columns != m_Columns)
+			return false;
+
+		unsigned int uPoint[RECORD_MAX_DIM];
+		unsigned int uVolt[RECORD_MAX_DIM];
+		unsigned int vPoint[RECORD_MAX_DIM];
+		unsigned int vVolt[RECORD_MAX_DIM];
+		for (unsigned int u = 0; u < m_Columns; u++)
+		{
+			uPoint[u] = record.uPoint[u];
+			uVolt[u] = record.uVolt[u];
+		}
 		for (unsigned int v = 0; v < m_Rows; v++)
 		{
-			switch (Solve(v, false))
+			vPoint[v] = record.vPoint[v];
+			vVolt[v] = record.vVolt[v];
+		}
+
+		ResetBoard();
+		if (!SetHints(uPoint, vPoint, uVolt, vVolt))
+			return false;
+
+		//	A user-confirmed field holds exactly one type besides the confirmation.
+		for (unsigned int field = 0; field < m_Columns * m_Rows; field++)
+		{
+			unsigned char memo = record.memos[field] & (MEMO_1 | MEMO_2 | MEMO_3 | MEMO_VOLT);
+			if (((record.userConf >> field) & 1) && std::has_single_bit(memo))
+				SetMemo(field / m_Rows, field % m_Rows, (MEMO_TYPE)memo);
+		}
+
+		return true;
+	}
+
+	double Solver::GetBoardCount() const
+	{
+		BoardCounter counter(m_Rows, m_Columns);
+		return counter.Count(m_uPoint, m_vPoint, m_uVolt, m_vVolt, m_Memos, nullptr, nullptr);
+	}
+
+	bool Solver::GetProbabilities(double* probabilities) const
+	{
+		double threeWeights[GAME_ROWS * GAME_COLUMNS + 1];
+		bool isWeighted = GetThreeWeights(threeWeights);
+
+		//	The weights are tiny chances, the fractions do not depend on their scale.
+		BoardCounter counter(m_Rows, m_Columns);
+		double boardCount = counter.Count(m_uPoint, m_vPoint, m_uVolt, m_vVolt, m_Memos, probabilities, isWeighted ? threeWeights : nullptr);
+		if (boardCount <= 0.0)
+			return false;
+
+		for (unsigned int i = 0; i < m_Columns * m_Rows * BoardCounter::VALUE_COUNT; i++)
+			probabilities[i] /= boardCount;
+
+		return true;
+	}
+
+	void Solver::SetGameLevel(unsigned int level)
+	{
+		m_GameLevel = level <= LEVEL_COUNT ? level : 0;
+	}
+
+	unsigned int Solver::GetGameLevel() const
+	{
+		return m_GameLevel;
+	}
+
+	bool Solver::GetThreeWeights(double* threeWeights) const
+	{
+		constexpr unsigned int FIELD_COUNT = GAME_ROWS * GAME_COLUMNS;
+		if (m_Rows != GAME_ROWS || m_Columns != GAME_COLUMNS)
+			return false;
+
+		//	The hints fix the count of volts and the sum of all values, so a configuration matches if its 1s, 2s and 3s add up to that sum.
+		unsigned int pointSum = 0;
+		unsigned int voltSum = 0;
+		for (unsigned int u = 0; u < m_Columns; u++)
+		{
+			pointSum += m_uPoint[u];
+			voltSum += m_uVolt[u];
+		}
+
+		//	First the configurations of the set level, then those of every level, each level with equal chance.
+		for (unsigned int pass = m_GameLevel ? 0 : 1; pass < 2; pass++)
+		{
+			unsigned int firstLevel = pass == 0 ? m_GameLevel - 1 : 0;
+			unsigned int levelCount = pass == 0 ? 1 : LEVEL_COUNT;
+
+			bool isMatched = false;
+			for (unsigned int i = 0; i <= FIELD_COUNT; i++)
+				threeWeights[i] = 0.0;
+
+			for (unsigned int level = firstLevel; level < firstLevel + levelCount; level++)
 			{
-			case SOLVE_NO_CHANGE:
-				break;
-			case SOLVE_CHANGED:
-				isAnythingChanged = true;
-				break;
-			case SOLVE_CONTRADICTION:
-				return SOLVE_CONTRADICTION;
+				for (unsigned int i = 0; i < LEVEL_CONFIG_COUNT; i++)
+				{
+					const LevelConfig& config = LEVEL_CONFIGS[level][i];
+					unsigned int ones = FIELD_COUNT - config.twos - config.threes - config.volts;
+					if (config.volts != voltSum || ones + 2 * config.twos + 3 * config.threes != pointSum)
+						continue;
+
+					threeWeights[config.threes] += LEVEL_CONFIG_BOARD_CHANCES.chances[level][i] / (LEVEL_CONFIG_COUNT * levelCount);
+					isMatched = true;
+				}
 			}
+
+			if (isMatched)
+				return true;
 		}
 
-		return isAnythingChanged ? SOLVE_CHANGED : SOLVE_NO_CHANGE;
+		return false;
 	}
 
-	void Solver::CommitTemporarySolution()
+	unsigned long long Solver::EnumerateBoards(unsigned int threadCount, const BoardEnumerator::Callback& callback) const
+	{
+		BoardEnumerator enumerator(m_Rows, m_Columns, threadCount);
+		return enumerator.Enumerate(m_uPoint, m_vPoint, m_uVolt, m_vVolt, m_Memos, callback);
+	}
+
+	MoveSearch::Result Solver::FindBestMove() const
+	{
+		//	The book only holds boards with nothing revealed, whose memos follow from the hints alone.
+		if (m_OpeningBook && std::none_of(m_UserConf, m_UserConf + m_Columns * m_Rows, [](bool isUserConf) { return isUserConf; }))
+		{
+			MoveSearch::Result result;
+			if (m_OpeningBook->Find(m_Rows, m_Columns, m_uPoint, m_vPoint, m_uVolt, m_vVolt, result))
+				return result;
+		}
+
+		MoveSearch search(m_Rows, m_Columns);
+		return search.FindBestMove(m_uPoint, m_vPoint, m_uVolt, m_vVolt, m_Memos, m_UserConf);
+	}
+
+	void Solver::SetOpeningBook(const OpeningBook* book)
+	{
+		m_OpeningBook = book;
+	}
+
+	LineCache::Stats Solver::GetLineCacheStats() const
+	{
+		LineCache::Stats stats {};
+		for (const LineScratch& scratch : m_Scratches)
+		{
+			LineCache::Stats scratchStats = scratch.lineCache.GetStats();
+			stats.hits += scratchStats.hits;
+			stats.misses += scratchStats.misses;
+		}
+		return stats;
+	}
+
+	Solver::Stats Solver::GetStats() const
+	{
+		Stats stats = m_Stats;
+		for (const LineScratch& scratch : m_Scratches)
+		{
+			stats.lineSolves += scratch.stats.lineSolves;
+			stats.tableFilters += scratch.stats.tableFilters;
+			stats.lookupEntries += scratch.stats.lookupEntries;
+		}
+
+		LineCache::Stats cacheStats = GetLineCacheStats();
+		stats.lineCacheHits = cacheStats.hits;
+		stats.lineCacheMisses = cacheStats.misses;
+
+		stats.lookupBytes = m_IsStaticLookup ? sizeof(STATIC_LOOKUP_TABLE) : (m_LookupArena ? GetLookupArenaSize(max(m_Columns, m_Rows)) : 0);
+		stats.lineTableBytes = m_LineTable.GetByteSize();
+		return stats;
+	}
+
+	void Solver::ResetStats()
+	{
+		m_Stats = Stats {};
+		for (LineScratch& scratch : m_Scratches)
+		{
+			scratch.stats = Stats {};
+			scratch.lineCache.ResetStats();
+		}
+	}
+
+	void Solver::Stats::Add(const Stats& other)
+	{
+		userActions += other.userActions;
+		replayedActions += other.replayedActions;
+		rollbacks += other.rollbacks;
+		rolledBackMemos += other.rolledBackMemos;
+		fullSolves += other.fullSolves;
+		solveRounds += other.solveRounds;
+		contradictions += other.contradictions;
+		retractions += other.retractions;
+		cancellations += other.cancellations;
+		lineSolves += other.lineSolves;
+		tableFilters += other.tableFilters;
+		lookupEntries += other.lookupEntries;
+		lineCacheHits += other.lineCacheHits;
+		lineCacheMisses += other.lineCacheMisses;
+		lookupBytes += other.lookupBytes;
+
+		//	The LineTable is shared, so its bytes are not summed.
+		lineTableBytes = max(lineTableBytes, other.lineTableBytes);
+	}
+
+	void Solver::Stats::WriteJson(std::ostream& stream) const
 	{
-		if(m_Columns && m_Rows)
-			memcpy(m_Memos, m_MemosTemp, sizeof(*m_Memos) * m_Columns * m_Rows);
+		stream << "{ \"userActions\": " << userActions
+			<< ", \"replayedActions\": " << replayedActions
+			<< ", \"rollbacks\": " << rollbacks
+			<< ", \"rolledBackMemos\": " << rolledBackMemos
+			<< ", \"fullSolves\": " << fullSolves
+			<< ", \"solveRounds\": " << solveRounds
+			<< ", \"contradictions\": " << contradictions
+			<< ", \"retractions\": " << retractions
+			<< ", \"cancellations\": " << cancellations
+			<< ", \"lineSolves\": " << lineSolves
+			<< ", \"lineSolvesPerAction\": " << (userActions ? (double)lineSolves / userActions : 0.0)
+			<< ", \"tableFilters\": " << tableFilters
+			<< ", \"lookupEntries\": " << lookupEntries
+			<< ", \"lineCacheHits\": " << lineCacheHits
+			<< ", \"lineCacheMisses\": " << lineCacheMisses
+			<< ", \"lookupBytes\": " << lookupBytes
+			<< ", \"lineTableBytes\": " << lineTableBytes
+			<< " }";
 	}
 
 	void Solver::PrintBoard() const
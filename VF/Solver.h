@@ -1,7 +1,30 @@
 #pragma once
 
+#include "BitBoard.h"
+#include "LineCache.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <queue>
+#include <vector>
+
+//	Set to 0 to compile the counters of VF::Solver::Stats out of the hot paths.
+#ifndef VF_SOLVER_STATS
+#define VF_SOLVER_STATS 1
+#endif
+
 namespace VF
 {
+	struct BoardRecord;
+	struct MemoCounts;
+	struct MoveResult;
+	class LineTable;
+	class OpeningBook;
+	class WorkerPool;
+
 	class Solver
 	{
 	public:
@@ -14,6 +37,33 @@ namespace VF
 			MEMO_CONF = 0b10000		// Field is confirmed
 		};
 
+		//	Counters of the hot paths since construction or the last ResetStats(). The counters stay 0 if VF_SOLVER_STATS is 0, except for the line cache and the sizes.
+		struct Stats
+		{
+			unsigned long long userActions;			//	Calls of SetMemo() and UnsetMemo(), including the SetMemo() calls replayed by UnsetMemo()
+			unsigned long long replayedActions;		//	SetMemo() calls replayed by UnsetMemo()
+			unsigned long long rollbacks;			//	UnsetMemo() calls that rolled the trail back
+			unsigned long long rolledBackMemos;		//	Trail entries undone by those rollbacks
+			unsigned long long fullSolves;			//	UnsetMemo() calls that had to solve the board from scratch
+			unsigned long long solveRounds;			//	Propagations of the queued lines to a fixpoint or contradiction
+			unsigned long long contradictions;		//	Propagations that ended in a contradiction
+			unsigned long long retractions;			//	User memos withdrawn because they caused a contradiction
+			unsigned long long cancellations;		//	Propagations stopped early by the cancel flag, see SetCancelFlag()
+			unsigned long long lineSolves;			//	Columns/rows solved
+			unsigned long long tableFilters;		//	Lines solved against the packed assignments of the LineTable
+			unsigned long long lookupEntries;		//	Lookup entries solved by SolveLookup() for longer lines
+			unsigned long long lineCacheHits;
+			unsigned long long lineCacheMisses;
+			size_t lookupBytes;						//	Bytes of the lookup used by the solver, the compile-time table for small boards
+			size_t lineTableBytes;					//	Bytes of the LineTable shared by all solvers
+
+			//	Adds the counters of another solver, e.g. to sum up the solvers of several threads.
+			void Add(const Stats& other);
+
+			//	Writes the stats as one JSON object, including the line solves per user action.
+			void WriteJson(std::ostream& stream) const;
+		};
+
 		Solver(unsigned int rows, unsigned int columns);
 
 		~Solver();
@@ -27,14 +77,70 @@ namespace VF
 		//	Sets and confirms a memo, returns the new memo
 		unsigned char SetMemo(unsigned int column, unsigned int row, MEMO_TYPE memo);
 
-		//	Unsets a memo and solves the board again, return the new memo
+		//	Unsets a memo and solves the board again, return the new memo.
+		//	Rolls the board back to before the memo was set and replays the later user actions, instead of solving from scratch if possible.
 		unsigned char UnsetMemo(unsigned int column, unsigned int row);
 
 		bool IsMemoUserConfirmed(unsigned int column, unsigned int row) const;
 
+		//	Resets all memos, including the user-confirmed ones, so the solver can be reused for a new board.
+		void ResetBoard();
+
 		//	Sets the hints on the sides of the board, returns whether the hints are legal.
 		bool SetHints(const unsigned int* uPoint, const unsigned int* vPoint, const unsigned int* uVolt, const unsigned int* vVolt);
 
+		//	Writes the hints, the memos and the user-confirmed fields to a record, whose RECORD_VALID flag tells whether the last SetHints() succeeded.
+		//	Returns false if the board does not fit into a record.
+		bool SaveRecord(BoardRecord& record) const;
+
+		//	Resets the board to the hints of a record and sets its user-confirmed memos in column-major order, the other memos of the record are solved again.
+		//	Returns false if the record has other dimensions than the solver or its hints are not legal.
+		bool LoadRecord(const BoardRecord& record);
+
+		//	Gets the count of full boards consistent with the hints and memos, see BoardCounter::Count().
+		double GetBoardCount() const;
+
+		//	Gets the fraction of consistent boards in which each field is a 1, 2, 3 or volt.
+		//	Fills BoardCounter::VALUE_COUNT values per field in column-major order, returns whether any consistent board exists.
+		//	On a board of the game, every board is weighted by the chance that the game generates it on the level set by SetGameLevel(), see GetThreeWeights().
+		bool GetProbabilities(double* probabilities) const;
+
+		//	Sets the level of HG/SS (1 to LEVEL_COUNT) whose board configurations GetProbabilities() weights the boards with, or 0 if the level is not known.
+		//	Only boards of GAME_ROWS x GAME_COLUMNS are weighted. Kept by ResetBoard() and SetHints().
+		void SetGameLevel(unsigned int level);
+
+		unsigned int GetGameLevel() const;
+
+		//	Calls callback for every full board consistent with the hints and memos, on threadCount threads, see BoardEnumerator::Enumerate().
+		//	callback is a BoardEnumerator::Callback. Returns the count of boards passed to callback.
+		unsigned long long EnumerateBoards(unsigned int threadCount, const std::function<bool(const uint64_t* board, unsigned int worker)>& callback) const;
+
+		//	Finds the field to flip next that maximizes the probability to clear the board, see MoveSearch. User-confirmed fields count as revealed.
+		//	As long as no field is user-confirmed, the move is looked up in the opening book first if one is set.
+		MoveResult FindBestMove() const;
+
+		//	Sets the opening book FindBestMove() looks the first move up in, nullptr removes it. The book has to outlive the solver or be removed first.
+		void SetOpeningBook(const OpeningBook* book);
+
+		//	Gets the hit/miss statistics of the caches of solved lines, summed over all threads.
+		LineCache::Stats GetLineCacheStats() const;
+
+		Stats GetStats() const;
+
+		void ResetStats();
+
+		//	Opt-in: boards with at least 16 rows and columns solve all queued columns at the same time on this many threads, then all queued rows.
+		//	The solved memos are the same as with a single thread, which is the default.
+		void SetThreadCount(unsigned int threadCount);
+
+		//	Lets another thread stop the solve of SetMemo(), UnsetMemo() or SetHints() early by setting *isCancelled, nullptr removes the flag.
+		//	A stopped solve leaves the memos sound but not fully narrowed, and the next solve propagates the whole board again.
+		void SetCancelFlag(const std::atomic<bool>* isCancelled);
+
+		//	Solves one column/row against its hints as if no other line had been solved yet, i.e. with every field open that is not user-confirmed.
+		//	Neither propagates nor changes the memos, returns whether the line has a legal arrangement. Meant for benchmarks of the line solver.
+		bool SolveSingleLine(unsigned int index, bool isColumn, bool isCacheEnabled);
+
 		void PrintBoard() const;
 
 	private:
@@ -42,33 +148,108 @@ namespace VF
 		{
 			SOLVE_NO_CHANGE,		//	There was no change on the board.
 			SOLVE_CHANGED,			//	There was a change on the board.
-			SOLVE_CONTRADICTION		//	There was a contradiction on the board.
+			SOLVE_CONTRADICTION,	//	There was a contradiction on the board.
+			SOLVE_CANCELLED			//	The cancel flag was set before the board was stable.
 		};
 
-		//	Creates the arrays holding lookup information for which possibilities of values exist for different row/column lengths, available points/volts, known point-/volt-fields. Returns whether the arrays were created successfully.
+		//	Points m_LookupOffsets/m_LookupEntries at the lookup information for which possibilities of values exist for different row/column lengths and available points/volts,
+		//	filling m_LookupArena first unless the compile-time table is used. Returns whether the lookup is available.
 		bool CreateLookupArrays();
 
 		//	Reset all memos that are not user-confirmed.
 		void ResetMemos();
 
-		//	Repeatedly call Solve() until no more changes are possible, or a contradiction is encountered.
+		//	Fills the weights of BoardCounter::Count() per count of 3s: the chance of one board with that many 3s under the configurations of the game level
+		//	that match the hint totals, or of every level if the game level is not known or none of its configurations matches.
+		//	Returns false if the board is not a board of the game or no configuration matches, then every board counts the same.
+		bool GetThreeWeights(double* threeWeights) const;
+
+		//	Repeatedly call Solve() on the queued lines until no more changes are possible, or a contradiction is encountered.
 		void SolveUntilStable();
 
-		bool SolveLookupRecurse(unsigned int level, unsigned int elemCount);
+		//	Scratch memory of one thread solving lines.
+		struct LineScratch
+		{
+			explicit LineScratch(unsigned int maxFields);
+
+			//	Candidate masks of the unconfirmed fields of the line being solved, and the types found legal for them.
+			std::vector<unsigned char> possibilitiesIn;
+			std::vector<unsigned char> possibilitiesOut;
+
+			//	Reachability states of SolveLookup(), grows to the largest lookup solved so far.
+			std::vector<unsigned char> lookupReach;
+
+			//	Results of SolveLine() for recently solved line situations, kept across boards.
+			LineCache lineCache;
+			bool isCacheEnabled;
+
+			//	Positions within their line of the fields changed by SolveFields().
+			std::vector<unsigned int> changed;
+
+			//	Counters of the lines solved with this scratch, only lineSolves, tableFilters and lookupEntries are used.
+			Stats stats;
+		};
+
+		//	Adds every type each unconfirmed field can take in some legal arrangement of the lookup to scratch.possibilitiesOut, returns whether any legal arrangement exists.
+		bool SolveLookup(const MemoCounts& memoCounts, unsigned int fieldCount, LineScratch& scratch) const;
 
+		//	Adds every type each unconfirmed field can take in some legal arrangement of the line to scratch.possibilitiesOut, returns whether any legal arrangement exists.
+		//	Lines with up to LineTable::MAX_FIELDS unconfirmed fields are filtered against their packed assignments, longer lines go through the lookup.
+		bool SolveLine(unsigned int missingFields, unsigned int missingPoints, unsigned int missingVolts, LineScratch& scratch) const;
+
+		//	Solves a column/row and queues the lines crossing its changed fields.
 		SOLVE_RESULT Solve(unsigned int index, bool isColumn);
 
-		//	Does one solving iteration over all temporary rows and columns, returns whether anything was changed.
-		SOLVE_RESULT SolveAll();
+		//	Solves a column/row without touching the queue, the positions of the changed fields are appended to scratch.changed.
+		//	Only writes the fields of this line, so lines without a common field can be solved at the same time.
+		SOLVE_RESULT SolveFields(unsigned int index, bool isColumn, LineScratch& scratch);
+
+		//	Solves queued lines until the queue is empty, returns SOLVE_NO_CHANGE once the temporary solution is stable.
+		SOLVE_RESULT SolveQueued();
+
+		//	SolveQueued() for the parallel engine, see SetThreadCount().
+		SOLVE_RESULT SolveQueuedParallel();
+
+		//	Whether the cancel flag is set.
+		bool IsCancelled() const;
+
+		//	Whether the lines are solved by the parallel engine.
+		bool IsParallel() const;
+
+		//	Queues a column/row to be solved, unless it is queued already. Lines with fewer unconfirmed fields are solved first.
+		void QueueLine(unsigned int index, bool isColumn);
+
+		//	Queues every column and row.
+		void QueueAllLines();
+
+		void ClearQueue();
+
+		//	Gets the count of unconfirmed fields of a temporary column/row.
+		unsigned int GetMissingFieldCount(unsigned int index, bool isColumn) const;
 
-		//	Commit the current temporary solution as the new legal solution.
+		//	Sets the memo of a field in m_MemosTemp and m_MemosTempRows.
+		void SetMemoTemp(unsigned int column, unsigned int row, unsigned char memo);
+
+		//	Copies the current legal solution into m_MemosTemp, m_MemosTempRows and, if enabled, m_PlanesTemp.
+		void LoadMemosTemp();
+
+		//	Commit the current temporary solution as the new legal solution, and record the changed memos on the trail.
 		void CommitTemporarySolution();
 
+		//	Sets the memo of a field in m_Memos, and records the memo from before on the trail.
+		void SetMemoTrailed(unsigned int field, unsigned char memo);
+
+		//	Clears the trail and the user actions, a later UnsetMemo() solves the board from scratch.
+		void ClearTrail();
+
 		bool m_IsLookupInitialized;
 
 		unsigned int const m_Columns;
 		unsigned int const m_Rows;
 
+		//	Whether the board is small enough to use the compile-time lookup table instead of m_LookupArena.
+		bool const m_IsStaticLookup;
+
 		unsigned int* const m_uPoint;
 		unsigned int* const m_vPoint;
 		unsigned int* const m_uVolt;
@@ -80,27 +261,85 @@ namespace VF
 		//  Column-major matrix of the memos of the playing field during a solver loop, may be resetted in case of contradiction
 		unsigned char* const m_MemosTemp;
 
-		unsigned char* const m_PossibilitiesTempIn;
-		unsigned char* const m_PossibilitiesTempOut;
+		//	Row-major copy of m_MemosTemp, kept in sync by SetMemoTemp() and LoadMemosTemp() so that rows are read as contiguously as columns
+		unsigned char* const m_MemosTempRows;
+
+		//	Whether the board is small enough to mirror m_MemosTemp in m_PlanesTemp.
+		bool const m_IsPlanesEnabled;
+
+		//	Bitplanes mirroring m_MemosTemp during a solver loop, only kept in sync if m_IsPlanesEnabled
+		BitBoard m_PlanesTemp;
+
+		//	Scratch memory per thread, the first one is used by the serial engine
+		std::vector<LineScratch> m_Scratches;
 
-		MEMO_TYPE* const m_LookupTemp;
+		//	Counters of the serial paths, the line counters are kept per scratch
+		Stats m_Stats;
+
+		//	Threads of the parallel engine, only created by SetThreadCount()
+		std::unique_ptr<WorkerPool> m_Pool;
+
+		//	Lines solved by the current phase of the parallel engine
+		std::vector<unsigned int> m_PhaseLines;
+
+		//	Set by another thread to stop the current solve, see SetCancelFlag()
+		const std::atomic<bool>* m_CancelFlag;
+
+		//	Level of the game for GetProbabilities(), 0 if not known
+		unsigned int m_GameLevel;
+
+		//	First moves for FindBestMove(), see SetOpeningBook()
+		const OpeningBook* m_OpeningBook;
+
+		//	Whether the last SetHints() accepted the hints, for SaveRecord()
+		bool m_IsHintsValid;
+
+		//	Packed assignments of short lines, shared by all solvers
+		const LineTable& m_LineTable;
 
 		//	Column-major matrix showing which fields are user-confirmed and should not be reset by ResetMemos()
 		bool* const m_UserConf;
 
-		//	Array of arrays (for columns/rows with specific points and volts left) with the counts of the available combinations
-		unsigned int** const m_LookupCounts;
+		//	Single allocation holding the lookup for larger boards: the offsets of every lookup slot, followed by the entries, laid out like LookupTable
+		unsigned char* const m_LookupArena;
+
+		//	Offsets into m_LookupEntries per lookup slot (see GetLookupSlot()), the entries of slot s are m_LookupEntries[m_LookupOffsets[s]] up to m_LookupEntries[m_LookupOffsets[s + 1]]
+		const unsigned int* m_LookupOffsets;
 
-		struct MemoCounts
+		//	Available combinations of all lookup slots, in either the compile-time table or m_LookupArena
+		const MemoCounts* m_LookupEntries;
+
+		//	Whether m_Memos is a stable solution, so that after a single change only the crossing lines have to be solved again.
+		bool m_IsMemosStable;
+
+		//	Queued lines, each encoded as (missing field count << 32 | line), where lines are the columns followed by the rows.
+		std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>> m_LineQueue;
+
+		//	Per line (columns followed by rows): whether it is in m_LineQueue.
+		std::vector<bool> m_IsLineQueued;
+
+		//	A memo of m_Memos that was changed, together with the memo from before the change.
+		struct TrailEntry
 		{
-			unsigned char memo1;
-			unsigned char memo2;
-			unsigned char memo3;
-			unsigned char memoV;
+			unsigned int field;
+			unsigned char memo;
 		};
 
-		//	Array of arrays (for columns/rows with specific points and volts left) of arrays with the available combinations
-		MemoCounts*** const m_Lookups;
+		//	A memo set by the user via SetMemo(), and where the trail entries it caused start.
+		struct UserAction
+		{
+			unsigned int field;
+			MEMO_TYPE memo;
+			bool wasUserConf;		//	Whether the field was user-confirmed before this action, i.e. whether it overwrote a user memo.
+			size_t trailStart;		//	Size of m_Trail before this action.
+			bool isRetracted;		//	Whether the memo led to a contradiction and its opposite was set instead.
+		};
+
+		//	Every change of m_Memos since the first user action, in order.
+		std::vector<TrailEntry> m_Trail;
+
+		//	Every user action since the hints were set, in order.
+		std::vector<UserAction> m_UserActions;
 
 		unsigned int m_LastUserColumn;
 		unsigned int m_LastUserRow;
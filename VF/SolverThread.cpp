@@ -0,0 +1,189 @@
+#include "SolverThread.h"
+
+#include <algorithm>
+
+namespace VF
+{
+	SolverThread::SolverThread(unsigned int rows, unsigned int columns, Notify onPublish)
+		: m_Rows(rows), m_Columns(columns), m_IsValid(false), m_OnPublish(std::move(onPublish)), m_IsStopping(false),
+		m_IsCancelled(false), m_PendingCount(0), m_Front(0), m_Back(1), m_Middle(2)
+	{
+		//	A fixed-size solve is too short to need cancelling.
+		if (rows == GAME_ROWS && columns == GAME_COLUMNS)
+			m_GameSolver = std::make_unique<FixedSolver<GAME_ROWS, GAME_COLUMNS>>();
+		else if (rows == 8 && columns == 8)
+			m_Solver8x8 = std::make_unique<FixedSolver<8, 8>>();
+		else
+		{
+			m_Solver = std::make_unique<Solver>(rows, columns);
+			m_Solver->SetCancelFlag(&m_IsCancelled);
+		}
+
+		//	Every snapshot starts as the empty board, and keeps its size, so publishing does not allocate.
+		for (Snapshot& snapshot : m_Snapshots)
+		{
+			snapshot.rows = m_Rows;
+			snapshot.columns = m_Columns;
+			snapshot.memos.resize(snapshot.rows * snapshot.columns);
+			snapshot.userConf.resize(snapshot.rows * snapshot.columns);
+			CopyBoard(snapshot);
+		}
+
+		m_Thread = std::thread(&SolverThread::Work, this);
+	}
+
+	SolverThread::~SolverThread()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_IsStopping = true;
+			m_IsCancelled = true;
+		}
+		m_Condition.notify_one();
+
+		m_Thread.join();
+	}
+
+	void SolverThread::SetHints(const unsigned int* uPoint, const unsigned int* vPoint, const unsigned int* uVolt, const unsigned int* vVolt)
+	{
+		unsigned int columns = m_Columns;
+		unsigned int rows = m_Rows;
+
+		Action action { ACTION_SET_HINTS, 0, 0, Solver::MEMO_1, {} };
+		action.hints.reserve(2 * (columns + rows));
+		action.hints.insert(action.hints.end(), uPoint, uPoint + columns);
+		action.hints.insert(action.hints.end(), uVolt, uVolt + columns);
+		action.hints.insert(action.hints.end(), vPoint, vPoint + rows);
+		action.hints.insert(action.hints.end(), vVolt, vVolt + rows);
+		Push(std::move(action));
+	}
+
+	void SolverThread::SetMemo(unsigned int column, unsigned int row, Solver::MEMO_TYPE memo)
+	{
+		Push(Action { ACTION_SET_MEMO, column, row, memo, {} });
+	}
+
+	void SolverThread::UnsetMemo(unsigned int column, unsigned int row)
+	{
+		Push(Action { ACTION_UNSET_MEMO, column, row, Solver::MEMO_1, {} });
+	}
+
+	const SolverThread::Snapshot& SolverThread::GetSnapshot()
+	{
+		if (m_Middle.load(std::memory_order_acquire) & SNAPSHOT_FRESH)
+			m_Front = m_Middle.exchange(m_Front, std::memory_order_acq_rel) & ~SNAPSHOT_FRESH;
+
+		return m_Snapshots[m_Front];
+	}
+
+	bool SolverThread::IsSolving() const
+	{
+		return m_PendingCount.load() != 0;
+	}
+
+	void SolverThread::Push(Action&& action)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			//	New hints solve the board from scratch, so the running solve and the hints queued before are stale.
+			//	The queued memos are kept, as the user-confirmed fields carry over to the new hints.
+			if (action.type == ACTION_SET_HINTS)
+			{
+				size_t count = m_Actions.size();
+				m_Actions.erase(std::remove_if(m_Actions.begin(), m_Actions.end(), [](const Action& queued) { return queued.type == ACTION_SET_HINTS; }), m_Actions.end());
+				m_PendingCount -= (unsigned int)(count - m_Actions.size());
+
+				m_IsCancelled = true;
+			}
+
+			m_Actions.push_back(std::move(action));
+			m_PendingCount++;
+		}
+		m_Condition.notify_one();
+	}
+
+	void SolverThread::Work()
+	{
+		while (true)
+		{
+			Action action;
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_Condition.wait(lock, [this]() { return m_IsStopping || !m_Actions.empty(); });
+				if (m_IsStopping)
+					return;
+
+				action = std::move(m_Actions.front());
+				m_Actions.pop_front();
+				m_IsCancelled = false;
+			}
+
+			Apply(action);
+
+			//	Only publish the board once the queue ran dry, the intermediate boards would be outdated right away.
+			//	A cancelled solve is never the last one, the hints that cancelled it are still queued.
+			bool isIdle;
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				isIdle = m_Actions.empty() && !m_IsCancelled;
+			}
+
+			if (isIdle)
+				Publish();
+			m_PendingCount--;
+
+			if (isIdle && m_OnPublish)
+				m_OnPublish();
+		}
+	}
+
+	void SolverThread::Apply(const Action& action)
+	{
+		unsigned int columns = m_Columns;
+		unsigned int rows = m_Rows;
+
+		WithSolver([&](auto& solver)
+		{
+			switch (action.type)
+			{
+			case ACTION_SET_HINTS:
+			{
+				const unsigned int* hints = action.hints.data();
+				m_IsValid = solver.SetHints(hints, hints + 2 * columns, hints + columns, hints + 2 * columns + rows);
+				break;
+			}
+			case ACTION_SET_MEMO:
+				if (m_IsValid && action.column < columns && action.row < rows)
+					solver.SetMemo(action.column, action.row, action.memo);
+				break;
+			case ACTION_UNSET_MEMO:
+				if (m_IsValid && action.column < columns && action.row < rows)
+					solver.UnsetMemo(action.column, action.row);
+				break;
+			}
+		});
+	}
+
+	void SolverThread::Publish()
+	{
+		CopyBoard(m_Snapshots[m_Back]);
+		m_Back = m_Middle.exchange(m_Back | SNAPSHOT_FRESH, std::memory_order_acq_rel) & ~SNAPSHOT_FRESH;
+	}
+
+	void SolverThread::CopyBoard(Snapshot& snapshot) const
+	{
+		WithSolver([&snapshot](const auto& solver)
+		{
+			for (unsigned int u = 0; u < snapshot.columns; u++)
+			{
+				for (unsigned int v = 0; v < snapshot.rows; v++)
+				{
+					snapshot.memos[u * snapshot.rows + v] = solver.GetMemo(u, v);
+					snapshot.userConf[u * snapshot.rows + v] = solver.IsMemoUserConfirmed(u, v);
+				}
+			}
+		});
+		snapshot.isValid = m_IsValid;
+	}
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "Solver.h"
+#include "FixedSolver.h"
+#include "GameLevels.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace VF
+{
+	//	Runs a Solver on a thread of its own, so that a slow solve does not block the caller. Boards of the game size and 8x8 boards
+	//	run on the FixedSolver of their size instead, which gives the same memos.
+	//	The user actions are queued and applied in order. Setting new hints cancels the solve that is running and drops the hints still queued,
+	//	since the new hints solve the whole board again anyway. Every finished board is published as a snapshot, which one reader thread
+	//	takes without locking: the snapshots are triple-buffered, so the reader and the solver thread never touch the same one.
+	class SolverThread
+	{
+	public:
+		struct Snapshot
+		{
+			unsigned int rows;
+			unsigned int columns;
+
+			//	Column-major matrices of the memos and of whether the fields are user-confirmed, see Solver::GetMemo() and Solver::IsMemoUserConfirmed().
+			std::vector<unsigned char> memos;
+			std::vector<unsigned char> userConf;
+
+			//	Whether the last hints were legal, see Solver::SetHints().
+			bool isValid;
+		};
+
+		//	Called on the solver thread after a snapshot was published, e.g. to wake up the reader.
+		using Notify = std::function<void()>;
+
+		SolverThread(unsigned int rows, unsigned int columns, Notify onPublish);
+
+		//	Cancels the running solve and waits for the thread to stop, the queued actions are dropped.
+		~SolverThread();
+
+		SolverThread(const SolverThread&) = delete;
+		SolverThread& operator=(const SolverThread&) = delete;
+
+		//	Queue an action, see the functions of the same name of Solver. The hints are copied, memos are ignored while the hints are not legal.
+		void SetHints(const unsigned int* uPoint, const unsigned int* vPoint, const unsigned int* uVolt, const unsigned int* vVolt);
+		void SetMemo(unsigned int column, unsigned int row, Solver::MEMO_TYPE memo);
+		void UnsetMemo(unsigned int column, unsigned int row);
+
+		//	Gets the latest published snapshot, which stays unchanged until the next call. Must only be called by one thread.
+		const Snapshot& GetSnapshot();
+
+		//	Whether any queued action has not been solved yet.
+		bool IsSolving() const;
+
+	private:
+		enum ACTION_TYPE
+		{
+			ACTION_SET_HINTS,
+			ACTION_SET_MEMO,
+			ACTION_UNSET_MEMO
+		};
+
+		struct Action
+		{
+			ACTION_TYPE type;
+			unsigned int column;
+			unsigned int row;
+			Solver::MEMO_TYPE memo;
+
+			//	uPoint, uVolt of every column followed by vPoint, vVolt of every row, only for ACTION_SET_HINTS.
+			std::vector<unsigned int> hints;
+		};
+
+		void Push(Action&& action);
+
+		void Work();
+
+		void Apply(const Action& action);
+
+		//	Copies the board into the back snapshot and swaps it with the middle one.
+		void Publish();
+
+		void CopyBoard(Snapshot& snapshot) const;
+
+		//	Calls function with the solver of the board.
+		template <typename Function>
+		void WithSolver(Function&& function) const
+		{
+			if (m_GameSolver)
+				function(*m_GameSolver);
+			else if (m_Solver8x8)
+				function(*m_Solver8x8);
+			else
+				function(*m_Solver);
+		}
+
+		unsigned int m_Rows;
+		unsigned int m_Columns;
+
+		//	Only the solver for the dimensions of the board is created.
+		std::unique_ptr<Solver> m_Solver;
+		std::unique_ptr<FixedSolver<GAME_ROWS, GAME_COLUMNS>> m_GameSolver;
+		std::unique_ptr<FixedSolver<8, 8>> m_Solver8x8;
+
+		//	Whether the last hints were legal, only used by the solver thread.
+		bool m_IsValid;
+
+		Notify m_OnPublish;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+		std::deque<Action> m_Actions;
+		bool m_IsStopping;
+
+		//	Set to stop the running solve, reset when the next action is taken from the queue.
+		std::atomic<bool> m_IsCancelled;
+
+		//	Count of actions queued or being solved.
+		std::atomic<unsigned int> m_PendingCount;
+
+		//	Triple buffer of snapshots: the reader owns m_Snapshots[m_Front], the solver thread owns m_Snapshots[m_Back],
+		//	and m_Middle holds the index of the third one, with SNAPSHOT_FRESH set if it is newer than the reader's.
+		static constexpr unsigned int SNAPSHOT_FRESH = 0b100;
+		Snapshot m_Snapshots[3];
+		unsigned int m_Front;
+		unsigned int m_Back;
+		std::atomic<unsigned int> m_Middle;
+
+		//	Started last, once everything it uses is initialized.
+		std::thread m_Thread;
+	};
+}
@@ -0,0 +1,85 @@
+#include "WorkerPool.h"
+
+namespace VF
+{
+	WorkerPool::WorkerPool(unsigned int workerCount)
+		: m_Task(nullptr), m_TaskCount(0), m_NextTask(0), m_Batch(0), m_BusyCount(0), m_IsStopping(false)
+	{
+		for (unsigned int worker = 1; worker < workerCount; worker++)
+			m_Threads.emplace_back(&WorkerPool::Work, this, worker);
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_IsStopping = true;
+		}
+		m_StartCondition.notify_all();
+
+		for (std::thread& thread : m_Threads)
+			thread.join();
+	}
+
+	unsigned int WorkerPool::GetWorkerCount() const
+	{
+		return (unsigned int)m_Threads.size() + 1;
+	}
+
+	void WorkerPool::Run(unsigned int taskCount, const Task& task)
+	{
+		if (taskCount == 0)
+			return;
+
+		//	A single task is not worth waking any thread.
+		if (taskCount == 1 || m_Threads.empty())
+		{
+			for (unsigned int i = 0; i < taskCount; i++)
+				task(i, 0);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Task = &task;
+			m_TaskCount = taskCount;
+			m_NextTask = 0;
+			m_BusyCount = (unsigned int)m_Threads.size();
+			m_Batch++;
+		}
+		m_StartCondition.notify_all();
+
+		RunTasks(0);
+
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_DoneCondition.wait(lock, [this]() { return m_BusyCount == 0; });
+		m_Task = nullptr;
+	}
+
+	void WorkerPool::Work(unsigned int worker)
+	{
+		unsigned long long batch = 0;
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_StartCondition.wait(lock, [this, batch]() { return m_IsStopping || m_Batch != batch; });
+				if (m_IsStopping)
+					return;
+				batch = m_Batch;
+			}
+
+			RunTasks(worker);
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (--m_BusyCount == 0)
+				m_DoneCondition.notify_one();
+		}
+	}
+
+	void WorkerPool::RunTasks(unsigned int worker)
+	{
+		for (unsigned int i = m_NextTask++; i < m_TaskCount; i = m_NextTask++)
+			(*m_Task)(i, worker);
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace VF
+{
+	//	Fixed set of threads that run batches of tasks. The thread calling Run() works on the batch as well, as worker 0,
+	//	so a pool of n workers starts n - 1 threads which sleep between batches.
+	class WorkerPool
+	{
+	public:
+		//	Called once per task of a batch, with the index of the task and of the worker running it.
+		using Task = std::function<void(unsigned int index, unsigned int worker)>;
+
+		explicit WorkerPool(unsigned int workerCount);
+
+		~WorkerPool();
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		unsigned int GetWorkerCount() const;
+
+		//	Runs task for every index below taskCount, spread over all workers, and returns once every call returned.
+		void Run(unsigned int taskCount, const Task& task);
+
+	private:
+		void Work(unsigned int worker);
+
+		//	Takes tasks of the current batch until none are left.
+		void RunTasks(unsigned int worker);
+
+		std::vector<std::thread> m_Threads;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_StartCondition;
+		std::condition_variable m_DoneCondition;
+
+		//	The current batch, only changed by Run() while no thread works on it.
+		const Task* m_Task;
+		unsigned int m_TaskCount;
+		std::atomic<unsigned int> m_NextTask;
+
+		//	Incremented by every batch, so sleeping threads can tell a new batch from a spurious wakeup.
+		unsigned long long m_Batch;
+
+		//	Count of threads still working on the current batch.
+		unsigned int m_BusyCount;
+
+		bool m_IsStopping;
+	};
+}
@@ -0,0 +1,637 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <charconv>
+#include <cstring>
+#include <algorithm>
+#include <bit>
+
+#include "VF/Solver.h"
+#include "VF/BoardFile.h"
+#include "VF/FixedSolver.h"
+#include "VF/GameLevels.h"
+
+//	Headless batch solver.
+//
+//	Streams boards from a file or stdin, solves them on a pool of worker threads with one VF::Solver per worker,
+//	and writes the resulting memo grids in input order. The throughput is reported on stderr.
+//	Boards of the game size and 8x8 boards are solved with the VF::FixedSolver of their size instead, which gives the same memos.
+//
+//	Input format per board (whitespace separated, '#' starts a comment that runs until the end of the line):
+//		<rows> <columns>
+//		<uPoint of every column>
+//		<uVolt of every column>
+//		<vPoint of every row>
+//		<vVolt of every row>
+//		<count of confirmed memos>
+//		<column> <row> <1|2|3|V>	(once per confirmed memo)
+//
+//	Output format per board:
+//		board <index> <ok|invalid>
+//		<one line per row, one cell per column, each cell written as "123VC" with '.' for every memo that is not set>
+//
+//	Binary board files (see VF/BoardFile.h) are detected as input and mapped into memory, their user-confirmed memos are set in column-major order.
+//	With -f binary, the output is a binary board file with one record per board holding the hints, the solved memos and the user-confirmed fields,
+//	so text corpora can be converted once and then read without parsing.
+
+struct BoardMemo
+{
+	unsigned int column;
+	unsigned int row;
+	VF::Solver::MEMO_TYPE memo;
+};
+
+struct BoardJob
+{
+	unsigned int rows = 0;
+	unsigned int columns = 0;
+
+	std::vector<unsigned int> uPoint;
+	std::vector<unsigned int> uVolt;
+	std::vector<unsigned int> vPoint;
+	std::vector<unsigned int> vVolt;
+
+	std::vector<BoardMemo> memos;
+
+	//	Record of a binary input file, which replaces the hints and memos above.
+	const VF::BoardRecord* record = nullptr;
+
+	//	Whether the hints were legal, set by the worker.
+	bool isValid = false;
+
+	//	Column-major matrix of the solved memos, set by the worker for text output.
+	std::vector<unsigned char> result;
+
+	//	Solved board, set by the worker for binary output. isRecordValid is false if the board does not fit into a record.
+	VF::BoardRecord resultRecord;
+	bool isRecordValid = false;
+};
+
+class TokenReader
+{
+public:
+	explicit TokenReader(std::istream& stream)
+		: m_Stream(stream)
+	{
+	}
+
+	//	Reads the next token, skipping comments. Returns false at the end of the stream.
+	bool Next(std::string& token)
+	{
+		while (m_Stream >> token)
+		{
+			size_t commentStart = token.find('#');
+			if (commentStart == std::string::npos)
+				return true;
+
+			std::string rest;
+			std::getline(m_Stream, rest);
+
+			token.resize(commentStart);
+			if (!token.empty())
+				return true;
+		}
+
+		return false;
+	}
+
+	//	Reads the next token as an unsigned number. Returns false at the end of the stream or if the token is not a number.
+	bool NextUnsigned(unsigned int& value)
+	{
+		std::string token;
+		if (!Next(token))
+			return false;
+
+		auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), value);
+		return error == std::errc() && end == token.data() + token.size();
+	}
+
+private:
+	std::istream& m_Stream;
+};
+
+enum READ_RESULT
+{
+	READ_OK,			//	A board was read.
+	READ_END,			//	The stream ended before a new board started.
+	READ_MALFORMED		//	The board was malformed.
+};
+
+static READ_RESULT ReadBoard(TokenReader& reader, BoardJob& job)
+{
+	std::string token;
+	if (!reader.Next(token))
+		return READ_END;
+
+	auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), job.rows);
+	if (error != std::errc() || end != token.data() + token.size())
+		return READ_MALFORMED;
+
+	if (!reader.NextUnsigned(job.columns))
+		return READ_MALFORMED;
+
+	if (job.rows == 0 || job.columns == 0 || job.rows > 255 || job.columns > 255)
+		return READ_MALFORMED;
+
+	auto readHints = [&reader](std::vector<unsigned int>& hints, unsigned int count)
+	{
+		hints.resize(count);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			if (!reader.NextUnsigned(hints[i]))
+				return false;
+		}
+		return true;
+	};
+
+	if (!readHints(job.uPoint, job.columns) || !readHints(job.uVolt, job.columns) ||
+		!readHints(job.vPoint, job.rows) || !readHints(job.vVolt, job.rows))
+		return READ_MALFORMED;
+
+	unsigned int memoCount = 0;
+	if (!reader.NextUnsigned(memoCount) || memoCount > job.columns * job.rows)
+		return READ_MALFORMED;
+
+	job.memos.resize(memoCount);
+	for (BoardMemo& memo : job.memos)
+	{
+		if (!reader.NextUnsigned(memo.column) || !reader.NextUnsigned(memo.row) || !reader.Next(token))
+			return READ_MALFORMED;
+
+		if (memo.column >= job.columns || memo.row >= job.rows)
+			return READ_MALFORMED;
+
+		if (token == "1")
+			memo.memo = VF::Solver::MEMO_1;
+		else if (token == "2")
+			memo.memo = VF::Solver::MEMO_2;
+		else if (token == "3")
+			memo.memo = VF::Solver::MEMO_3;
+		else if (token == "V" || token == "v")
+			memo.memo = VF::Solver::MEMO_VOLT;
+		else
+			return READ_MALFORMED;
+	}
+
+	return READ_OK;
+}
+
+//	A solver per worker, together with the stats of the solvers it replaced, and the fixed-size solvers for the dimensions they exist for.
+struct Worker
+{
+	std::unique_ptr<VF::Solver> solver;
+	VF::Solver::Stats retiredStats {};
+
+	VF::FixedSolver<VF::GAME_ROWS, VF::GAME_COLUMNS> gameSolver;
+	VF::FixedSolver<8, 8> solver8x8;
+};
+
+//	Writes the hints and user memos of a board whose hints are illegal to a record, since the solver never took them.
+static bool CreateInvalidRecord(const BoardJob& job, VF::BoardRecord& record)
+{
+	if (job.record)
+	{
+		record = *job.record;
+		record.flags = 0;
+		return true;
+	}
+
+	if (!VF::BoardRecord::Fits(job.rows, job.columns))
+		return false;
+
+	record = VF::BoardRecord {};
+	record.rows = (uint8_t)job.rows;
+	record.columns = (uint8_t)job.columns;
+	for (unsigned int u = 0; u < job.columns; u++)
+	{
+		record.uPoint[u] = (uint8_t)job.uPoint[u];
+		record.uVolt[u] = (uint8_t)job.uVolt[u];
+	}
+	for (unsigned int v = 0; v < job.rows; v++)
+	{
+		record.vPoint[v] = (uint8_t)job.vPoint[v];
+		record.vVolt[v] = (uint8_t)job.vVolt[v];
+	}
+	for (const BoardMemo& memo : job.memos)
+	{
+		unsigned int field = memo.column * job.rows + memo.row;
+		record.memos[field] = memo.memo | VF::Solver::MEMO_CONF;
+		record.userConf |= 1ULL << field;
+	}
+	return true;
+}
+
+//	Sets the hints and the user-confirmed memos of a record like VF::Solver::LoadRecord(), for the fixed-size solvers.
+template <typename SolverType>
+static bool LoadRecord(SolverType& solver, const VF::BoardRecord& record)
+{
+	constexpr unsigned int rows = SolverType::GetRowCount();
+	constexpr unsigned int columns = SolverType::GetColumnCount();
+	if (record.rows != rows || record.columns != columns)
+		return false;
+
+	unsigned int uPoint[columns];
+	unsigned int uVolt[columns];
+	unsigned int vPoint[rows];
+	unsigned int vVolt[rows];
+	for (unsigned int u = 0; u < columns; u++)
+	{
+		uPoint[u] = record.uPoint[u];
+		uVolt[u] = record.uVolt[u];
+	}
+	for (unsigned int v = 0; v < rows; v++)
+	{
+		vPoint[v] = record.vPoint[v];
+		vVolt[v] = record.vVolt[v];
+	}
+
+	solver.ResetBoard();
+	if (!solver.SetHints(uPoint, vPoint, uVolt, vVolt))
+		return false;
+
+	for (unsigned int field = 0; field < columns * rows; field++)
+	{
+		unsigned char memo = record.memos[field] & (VF::Solver::MEMO_1 | VF::Solver::MEMO_2 | VF::Solver::MEMO_3 | VF::Solver::MEMO_VOLT);
+		if (((record.userConf >> field) & 1) && std::has_single_bit(memo))
+			solver.SetMemo(field / rows, field % rows, (VF::Solver::MEMO_TYPE)memo);
+	}
+	return true;
+}
+
+static bool LoadRecord(VF::Solver& solver, const VF::BoardRecord& record)
+{
+	return solver.LoadRecord(record);
+}
+
+//	Writes the solved board of a job with legal hints to a record like VF::Solver::SaveRecord(), for the fixed-size solvers.
+template <typename SolverType>
+static bool SaveRecord(const BoardJob& job, const SolverType& solver, VF::BoardRecord& record)
+{
+	//	Only the hints are taken over, the rest of an input record is not part of the result.
+	VF::BoardRecord hints;
+	if (!CreateInvalidRecord(job, hints))
+		return false;
+
+	record = VF::BoardRecord {};
+	record.rows = hints.rows;
+	record.columns = hints.columns;
+	record.flags = VF::BoardRecord::RECORD_VALID;
+	std::copy_n(hints.uPoint, job.columns, record.uPoint);
+	std::copy_n(hints.uVolt, job.columns, record.uVolt);
+	std::copy_n(hints.vPoint, job.rows, record.vPoint);
+	std::copy_n(hints.vVolt, job.rows, record.vVolt);
+	for (unsigned int u = 0; u < job.columns; u++)
+	{
+		for (unsigned int v = 0; v < job.rows; v++)
+		{
+			unsigned int field = u * job.rows + v;
+			record.memos[field] = solver.GetMemo(u, v);
+			if (solver.IsMemoUserConfirmed(u, v))
+				record.userConf |= 1ULL << field;
+		}
+	}
+	return true;
+}
+
+static bool SaveRecord(const BoardJob&, const VF::Solver& solver, VF::BoardRecord& record)
+{
+	return solver.SaveRecord(record);
+}
+
+template <typename SolverType>
+static void SolveBoard(BoardJob& job, SolverType& solver, bool isBinaryOutput)
+{
+	if (job.record)
+	{
+		job.isValid = LoadRecord(solver, *job.record);
+	}
+	else
+	{
+		job.isValid = solver.SetHints(job.uPoint.data(), job.vPoint.data(), job.uVolt.data(), job.vVolt.data());
+		if (job.isValid)
+		{
+			for (const BoardMemo& memo : job.memos)
+				solver.SetMemo(memo.column, memo.row, memo.memo);
+		}
+	}
+
+	if (isBinaryOutput)
+	{
+		job.isRecordValid = job.isValid ? SaveRecord(job, solver, job.resultRecord) : CreateInvalidRecord(job, job.resultRecord);
+		return;
+	}
+
+	job.result.resize(job.columns * job.rows);
+	for (unsigned int u = 0; u < job.columns; u++)
+	{
+		for (unsigned int v = 0; v < job.rows; v++)
+			job.result[u * job.rows + v] = solver.GetMemo(u, v);
+	}
+}
+
+static void SolveBoard(BoardJob& job, Worker& worker, bool isBinaryOutput)
+{
+	if (job.rows == VF::GAME_ROWS && job.columns == VF::GAME_COLUMNS)
+	{
+		worker.gameSolver.ResetBoard();
+		SolveBoard(job, worker.gameSolver, isBinaryOutput);
+		return;
+	}
+	if (job.rows == 8 && job.columns == 8)
+	{
+		worker.solver8x8.ResetBoard();
+		SolveBoard(job, worker.solver8x8, isBinaryOutput);
+		return;
+	}
+
+	std::unique_ptr<VF::Solver>& solver = worker.solver;
+
+	//	Only recreate the solver if the dimensions changed, creating the lookup arrays is the expensive part.
+	if (!solver || solver->GetRowCount() != job.rows || solver->GetColumnCount() != job.columns)
+	{
+		if (solver)
+			worker.retiredStats.Add(solver->GetStats());
+		solver = std::make_unique<VF::Solver>(job.rows, job.columns);
+	}
+	else
+		solver->ResetBoard();
+
+	SolveBoard(job, *solver, isBinaryOutput);
+}
+
+static void WriteBoard(std::string& out, const BoardJob& job, unsigned long long index)
+{
+	out += "board ";
+	out += std::to_string(index);
+	out += job.isValid ? " ok\n" : " invalid\n";
+
+	for (unsigned int v = 0; v < job.rows; v++)
+	{
+		for (unsigned int u = 0; u < job.columns; u++)
+		{
+			unsigned char memo = job.result[u * job.rows + v];
+			out += (memo & VF::Solver::MEMO_1) ? '1' : '.';
+			out += (memo & VF::Solver::MEMO_2) ? '2' : '.';
+			out += (memo & VF::Solver::MEMO_3) ? '3' : '.';
+			out += (memo & VF::Solver::MEMO_VOLT) ? 'V' : '.';
+			out += (memo & VF::Solver::MEMO_CONF) ? 'C' : '.';
+			out += (u + 1 < job.columns) ? ' ' : '\n';
+		}
+	}
+}
+
+static void PrintUsage()
+{
+	std::cerr <<
+		"Usage: VFBatch [-j threads] [-c chunkSize] [-o output] [-f text|binary] [-s stats] [input]\n"
+		"  Reads boards from input (or stdin if omitted or \"-\") and writes the solved memos to output (or stdout).\n"
+		"  input may be a text or a binary board file, binary output (default text) has to go to an output file.\n"
+		"  If stats is given, the solver counters summed over all threads are written to it as JSON. Boards of 5x5 and 8x8 use fixed-size solvers without counters.\n";
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int threadCount = std::thread::hardware_concurrency();
+	unsigned int chunkSize = 4096;
+	const char* inputPath = nullptr;
+	const char* outputPath = nullptr;
+	const char* statsPath = nullptr;
+	bool isBinaryOutput = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if ((arg == "-j" || arg == "-c" || arg == "-o" || arg == "-s") && i + 1 < argc)
+		{
+			const char* value = argv[++i];
+			if (arg == "-o" || arg == "-s")
+			{
+				(arg == "-o" ? outputPath : statsPath) = value;
+				continue;
+			}
+
+			unsigned int number = 0;
+			auto [end, error] = std::from_chars(value, value + std::strlen(value), number);
+			if (error != std::errc() || *end != '\0' || number == 0)
+			{
+				PrintUsage();
+				return 1;
+			}
+			(arg == "-j" ? threadCount : chunkSize) = number;
+		}
+		else if (arg == "-f" && i + 1 < argc)
+		{
+			std::string format = argv[++i];
+			if (format != "text" && format != "binary")
+			{
+				PrintUsage();
+				return 1;
+			}
+			isBinaryOutput = format == "binary";
+		}
+		else if (arg == "-h" || arg == "--help")
+		{
+			PrintUsage();
+			return 0;
+		}
+		else if (!inputPath)
+		{
+			inputPath = argv[i];
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (threadCount == 0)
+		threadCount = 1;
+
+	if (isBinaryOutput && !outputPath)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	std::ios::sync_with_stdio(false);
+
+	//	A binary input file is mapped and its records are solved in place.
+	VF::BoardFileReader corpus;
+	bool isBinaryInput = inputPath && std::string(inputPath) != "-" && corpus.Open(inputPath);
+	size_t nextRecord = 0;
+
+	std::ifstream inputFile;
+	if (inputPath && std::string(inputPath) != "-" && !isBinaryInput)
+	{
+		inputFile.open(inputPath);
+		if (!inputFile)
+		{
+			std::cerr << "[ERROR]\tCould not open input file " << inputPath << "." << std::endl;
+			return 1;
+		}
+	}
+	std::istream& input = inputFile.is_open() ? inputFile : std::cin;
+
+	VF::BoardFileWriter binaryOutput;
+	if (isBinaryOutput && !binaryOutput.Open(outputPath, false))
+	{
+		std::cerr << "[ERROR]\tCould not open output file " << outputPath << "." << std::endl;
+		return 1;
+	}
+
+	std::ofstream outputFile;
+	if (outputPath && !isBinaryOutput)
+	{
+		outputFile.open(outputPath, std::ios::binary);
+		if (!outputFile)
+		{
+			std::cerr << "[ERROR]\tCould not open output file " << outputPath << "." << std::endl;
+			return 1;
+		}
+	}
+	std::ostream& output = outputFile.is_open() ? outputFile : std::cout;
+
+	TokenReader reader(input);
+
+	//	One solver per worker, kept alive across chunks so the lookup arrays are only created once per dimension.
+	std::vector<Worker> workers(threadCount);
+	std::vector<BoardJob> jobs(chunkSize);
+	std::string out;
+
+	unsigned long long boardCount = 0;
+	bool isMalformed = false;
+	bool isOutputFailed = false;
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	while (!isMalformed && !isOutputFailed)
+	{
+		//	1. Read the next chunk of boards.
+		unsigned int jobCount = 0;
+		while (isBinaryInput && jobCount < chunkSize && nextRecord < corpus.GetRecordCount())
+		{
+			BoardJob& job = jobs[jobCount];
+			job.record = &corpus.GetRecord(nextRecord++);
+			job.rows = job.record->rows;
+			job.columns = job.record->columns;
+			if (!VF::BoardRecord::Fits(job.rows, job.columns))
+			{
+				std::cerr << "[ERROR]\tMalformed input at board " << boardCount + jobCount << "." << std::endl;
+				isMalformed = true;
+				break;
+			}
+			jobCount++;
+		}
+
+		while (!isBinaryInput && jobCount < chunkSize)
+		{
+			READ_RESULT readResult = ReadBoard(reader, jobs[jobCount]);
+			if (readResult == READ_OK)
+			{
+				jobCount++;
+				continue;
+			}
+
+			if (readResult == READ_MALFORMED)
+			{
+				std::cerr << "[ERROR]\tMalformed input at board " << boardCount + jobCount << "." << std::endl;
+				isMalformed = true;
+			}
+			break;
+		}
+
+		if (jobCount == 0)
+			break;
+
+		//	2. Solve the chunk, every worker takes the next unsolved board until none are left.
+		std::atomic<unsigned int> nextJob = 0;
+		auto work = [&jobs, &nextJob, jobCount, isBinaryOutput](Worker& worker)
+		{
+			for (unsigned int i = nextJob++; i < jobCount; i = nextJob++)
+				SolveBoard(jobs[i], worker, isBinaryOutput);
+		};
+
+		unsigned int workerCount = std::min(threadCount, jobCount);
+		std::vector<std::thread> threads;
+		threads.reserve(workerCount - 1);
+		for (unsigned int t = 1; t < workerCount; t++)
+			threads.emplace_back(work, std::ref(workers[t]));
+		work(workers[0]);
+		for (std::thread& thread : threads)
+			thread.join();
+
+		//	3. Write the chunk in input order.
+		if (isBinaryOutput)
+		{
+			for (unsigned int i = 0; i < jobCount && !isOutputFailed; i++)
+			{
+				if (!jobs[i].isRecordValid)
+				{
+					std::cerr << "[ERROR]\tBoard " << boardCount + i << " is too large for a binary record." << std::endl;
+					isOutputFailed = true;
+				}
+				else if (!binaryOutput.Write(&jobs[i].resultRecord, 1))
+				{
+					std::cerr << "[ERROR]\tCould not write output file " << outputPath << "." << std::endl;
+					isOutputFailed = true;
+				}
+			}
+		}
+		else
+		{
+			out.clear();
+			for (unsigned int i = 0; i < jobCount; i++)
+				WriteBoard(out, jobs[i], boardCount + i);
+			output.write(out.data(), out.size());
+		}
+
+		boardCount += jobCount;
+
+		if (jobCount < chunkSize)
+			break;
+	}
+
+	output.flush();
+	if (isBinaryOutput && !isOutputFailed && !binaryOutput.Flush())
+	{
+		std::cerr << "[ERROR]\tCould not write output file " << outputPath << "." << std::endl;
+		isOutputFailed = true;
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	std::cerr << "[INFO]\tSolved " << boardCount << " boards in " << seconds << " s (" <<
+		(seconds > 0.0 ? boardCount / seconds : 0.0) << " boards/s) on " << threadCount << " threads." << std::endl;
+
+	VF::Solver::Stats stats {};
+	for (const Worker& worker : workers)
+	{
+		stats.Add(worker.retiredStats);
+		if (worker.solver)
+			stats.Add(worker.solver->GetStats());
+	}
+
+	unsigned long long cacheHits = stats.lineCacheHits;
+	unsigned long long cacheMisses = stats.lineCacheMisses;
+	std::cerr << "[INFO]\tLine cache: " << cacheHits << " hits, " << cacheMisses << " misses (" <<
+		(cacheHits + cacheMisses ? 100.0 * cacheHits / (cacheHits + cacheMisses) : 0.0) << "% hits)." << std::endl;
+
+	if (statsPath)
+	{
+		std::ofstream statsFile(statsPath);
+		if (!statsFile)
+		{
+			std::cerr << "[ERROR]\tCould not open stats file " << statsPath << "." << std::endl;
+			return 1;
+		}
+		stats.WriteJson(statsFile);
+		statsFile << "\n";
+	}
+
+	return isMalformed || isOutputFailed ? 1 : 0;
+}
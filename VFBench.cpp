@@ -0,0 +1,749 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include <cctype>
+#include <random>
+#include <algorithm>
+#include <bit>
+#include <functional>
+
+#include "VF/Solver.h"
+#include "VF/FixedSolver.h"
+#include "VF/GameLevels.h"
+
+//	Benchmark suite.
+//
+//	Times three groups of operations and writes min, median and p99 per benchmark as JSON or CSV:
+//		construct	VF::Solver construction including the lookup, for a range of dimensions
+//		line		VF::Solver::SolveSingleLine() on every line state of cases.txt and on longer representative lines, with and without the line cache
+//		game		SetHints + SetMemo replays of fixed corpora of boards drawn from the seed: HG/SS levels on 5x5, random boards on larger dimensions,
+//					with VF::Solver and, where an instantiation exists, VF::FixedSolver
+//
+//	The verify group is not timed and only runs when selected. It replays the same kind of corpora and compares the solvers against references:
+//		fixpoint	VF::Solver after every SetMemo and UnsetMemo against a solve from scratch of the memos set so far, on 5x5, 6x7 and 8x8
+//		fixed		VF::FixedSolver against VF::Solver on 5x5 and 8x8, with right, wrong and unset memos
+//		parallel	VF::Solver with 4 threads against one thread on 16x16
+//	and exits with 1 if any of them differ.
+//
+//	Every sample of a benchmark times a batch of iterations and reports the time per iteration in nanoseconds, so that short operations
+//	are not dominated by the resolution of the clock. The corpora only depend on the seed, so results of two builds can be compared.
+
+struct BenchResult
+{
+	std::string group;
+	std::string name;
+	unsigned int samples;
+	double min;
+	double median;
+	double p99;
+};
+
+struct BenchOptions
+{
+	unsigned int samples = 31;
+	unsigned int gameCount = 200;
+	unsigned long long seed = 0;
+	const char* casesPath = "cases.txt";
+	const char* group = nullptr;
+};
+
+//	Runs the operation in samples batches of iterations each, returns the statistics of the time per iteration.
+//	The operation is run once before, so first-use initialization is not timed. An iteration count of 0 picks as many as fit about 1 ms.
+static BenchResult Measure(const std::string& group, const std::string& name, unsigned int samples, unsigned int iterations, const std::function<void()>& operation)
+{
+	auto warmUpTime = std::chrono::steady_clock::now();
+	operation();
+	if (iterations == 0)
+	{
+		double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - warmUpTime).count();
+		iterations = (unsigned int)std::clamp(1000000.0 / std::max(nanoseconds, 1.0), 1.0, 100000.0);
+	}
+
+	std::vector<double> times(samples);
+	for (double& time : times)
+	{
+		auto startTime = std::chrono::steady_clock::now();
+		for (unsigned int i = 0; i < iterations; i++)
+			operation();
+		time = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count() / iterations;
+	}
+
+	std::sort(times.begin(), times.end());
+
+	size_t p99Index = (size_t)((times.size() * 99 + 99) / 100) - 1;
+	double median = times.size() % 2 ? times[times.size() / 2] : (times[times.size() / 2 - 1] + times[times.size() / 2]) / 2.0;
+
+	return BenchResult { group, name, samples, times.front(), median, times[std::min(p99Index, times.size() - 1)] };
+}
+
+//	SplitMix64, turns the seed and the index of a board into a well-mixed seed for the RNG of that board.
+static uint64_t MixSeed(uint64_t seed, uint64_t board)
+{
+	uint64_t z = seed + (board + 1) * 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+static unsigned int Draw(std::mt19937_64& rng, unsigned int bound)
+{
+	return (unsigned int)(rng() % bound);
+}
+
+//	A board of a corpus, with its hints and the order in which its fields are set as memos during a replay.
+struct CorpusBoard
+{
+	std::vector<VF::Solver::MEMO_TYPE> values;		//	Column-major
+	std::vector<unsigned int> uPoint;
+	std::vector<unsigned int> uVolt;
+	std::vector<unsigned int> vPoint;
+	std::vector<unsigned int> vVolt;
+	std::vector<unsigned int> order;				//	Fields that are no volt, in the order they are set
+};
+
+struct Corpus
+{
+	std::string name;
+	unsigned int rows;
+	unsigned int columns;
+	std::vector<CorpusBoard> boards;
+};
+
+static void FinishBoard(std::mt19937_64& rng, unsigned int rows, unsigned int columns, CorpusBoard& board)
+{
+	board.uPoint.assign(columns, 0);
+	board.uVolt.assign(columns, 0);
+	board.vPoint.assign(rows, 0);
+	board.vVolt.assign(rows, 0);
+	board.order.clear();
+
+	for (unsigned int u = 0; u < columns; u++)
+	{
+		for (unsigned int v = 0; v < rows; v++)
+		{
+			unsigned int points = 0;
+			switch (board.values[u * rows + v])
+			{
+			case VF::Solver::MEMO_1: points = 1; break;
+			case VF::Solver::MEMO_2: points = 2; break;
+			case VF::Solver::MEMO_3: points = 3; break;
+			default:
+				board.uVolt[u]++;
+				board.vVolt[v]++;
+				break;
+			}
+			board.uPoint[u] += points;
+			board.vPoint[v] += points;
+
+			if (points)
+				board.order.push_back(u * rows + v);
+		}
+	}
+
+	for (size_t i = board.order.size(); i > 1; i--)
+		std::swap(board.order[i - 1], board.order[Draw(rng, (unsigned int)i)]);
+}
+
+//	Boards drawn from the HG/SS level configurations, every level equally often.
+static Corpus CreateLevelCorpus(unsigned long long seed, unsigned int boardCount)
+{
+	Corpus corpus { "levels5x5", VF::GAME_ROWS, VF::GAME_COLUMNS, std::vector<CorpusBoard>(boardCount) };
+
+	const unsigned int fieldCount = VF::GAME_ROWS * VF::GAME_COLUMNS;
+	for (unsigned int i = 0; i < boardCount; i++)
+	{
+		std::mt19937_64 rng(MixSeed(seed, i));
+		const VF::LevelConfig& config = VF::LEVEL_CONFIGS[i % VF::LEVEL_COUNT][Draw(rng, VF::LEVEL_CONFIG_COUNT)];
+
+		CorpusBoard& board = corpus.boards[i];
+		board.values.assign(fieldCount, VF::Solver::MEMO_1);
+
+		unsigned int field = 0;
+		for (unsigned int j = 0; j < config.twos; j++)
+			board.values[field++] = VF::Solver::MEMO_2;
+		for (unsigned int j = 0; j < config.threes; j++)
+			board.values[field++] = VF::Solver::MEMO_3;
+		for (unsigned int j = 0; j < config.volts; j++)
+			board.values[field++] = VF::Solver::MEMO_VOLT;
+
+		for (unsigned int j = fieldCount - 1; j > 0; j--)
+			std::swap(board.values[j], board.values[Draw(rng, j + 1)]);
+
+		FinishBoard(rng, corpus.rows, corpus.columns, board);
+	}
+
+	return corpus;
+}
+
+//	Boards of larger dimensions, with every field drawn independently: half 1s, a fifth 2s, a tenth 3s and a fifth volts.
+static Corpus CreateRandomCorpus(unsigned long long seed, unsigned int rows, unsigned int columns, unsigned int boardCount)
+{
+	Corpus corpus { "random" + std::to_string(rows) + "x" + std::to_string(columns), rows, columns, std::vector<CorpusBoard>(boardCount) };
+
+	for (unsigned int i = 0; i < boardCount; i++)
+	{
+		std::mt19937_64 rng(MixSeed(seed ^ ((uint64_t)rows << 40 | (uint64_t)columns << 32), i));
+
+		CorpusBoard& board = corpus.boards[i];
+		board.values.resize(rows * columns);
+		for (VF::Solver::MEMO_TYPE& value : board.values)
+		{
+			unsigned int draw = Draw(rng, 10);
+			value = draw < 5 ? VF::Solver::MEMO_1 : draw < 7 ? VF::Solver::MEMO_2 : draw < 8 ? VF::Solver::MEMO_3 : VF::Solver::MEMO_VOLT;
+		}
+
+		FinishBoard(rng, rows, columns, board);
+	}
+
+	return corpus;
+}
+
+template <typename SolverType>
+static void ReplayBoard(SolverType& solver, const CorpusBoard& board, unsigned int rows)
+{
+	solver.ResetBoard();
+	if (!solver.SetHints(board.uPoint.data(), board.vPoint.data(), board.uVolt.data(), board.vVolt.data()))
+		return;
+
+	for (unsigned int field : board.order)
+		solver.SetMemo(field / rows, field % rows, board.values[field]);
+}
+
+//	A line state of cases.txt: the count of unconfirmed fields with the points and volts still missing on them.
+struct LineCase
+{
+	unsigned int fields;
+	unsigned int points;
+	unsigned int volts;
+};
+
+//	Reads the header lines of cases.txt, e.g. "2 missing:	2, 3, 4, 5, 6, vv, 1v, 2v, 3v", where every entry is the missing points
+//	followed by one 'v' per missing volt.
+static bool ReadLineCases(const char* path, std::vector<LineCase>& cases)
+{
+	std::ifstream file(path);
+	if (!file)
+		return false;
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		size_t headerEnd = line.find(" missing:");
+		if (headerEnd == std::string::npos)
+			continue;
+
+		unsigned int fields = 0;
+		auto [end, error] = std::from_chars(line.data(), line.data() + headerEnd, fields);
+		if (error != std::errc() || end != line.data() + headerEnd || fields == 0)
+			continue;
+
+		std::stringstream entries(line.substr(headerEnd + 9));
+		std::string entry;
+		while (std::getline(entries, entry, ','))
+		{
+			entry.erase(std::remove_if(entry.begin(), entry.end(), [](char c) { return std::isspace((unsigned char)c); }), entry.end());
+			if (entry.empty())
+				continue;
+
+			size_t voltStart = entry.find_first_not_of("0123456789");
+			if (voltStart == std::string::npos)
+				voltStart = entry.size();
+
+			LineCase lineCase { fields, 0, (unsigned int)(entry.size() - voltStart) };
+			if (voltStart)
+				std::from_chars(entry.data(), entry.data() + voltStart, lineCase.points);
+			if (entry.find_first_not_of('v', voltStart) == std::string::npos)
+				cases.push_back(lineCase);
+		}
+	}
+
+	return true;
+}
+
+static void RunConstructBenchmarks(const BenchOptions& options, std::vector<BenchResult>& results)
+{
+	static constexpr unsigned int DIMENSIONS[] = { 5, 6, 8, 10, 12, 16, 24, 32 };
+
+	for (unsigned int dimension : DIMENSIONS)
+	{
+		results.push_back(Measure("construct", std::to_string(dimension) + "x" + std::to_string(dimension), options.samples, 1,
+			[dimension]()
+			{
+				VF::Solver solver(dimension, dimension);
+			}));
+	}
+}
+
+static void RunLineBenchmarks(const BenchOptions& options, std::vector<BenchResult>& results)
+{
+	std::vector<LineCase> cases;
+	if (!ReadLineCases(options.casesPath, cases))
+		std::cerr << "[WARNING]\tCould not open " << options.casesPath << ", only the representative lines are timed." << std::endl;
+
+	//	Longer lines with a typical share of volts and points, as on large variant boards.
+	for (unsigned int fields : { 8U, 12U, 16U, 24U })
+	{
+		unsigned int volts = fields / 4;
+		cases.push_back(LineCase { fields, (fields - volts) * 2, volts });
+	}
+
+	for (const LineCase& lineCase : cases)
+	{
+		//	Square board with the hints of the case on every line, which always has a solution (a cyclic Latin square of one arrangement).
+		unsigned int n = lineCase.fields;
+		VF::Solver solver(n, n);
+
+		std::vector<unsigned int> points(n, lineCase.points);
+		std::vector<unsigned int> volts(n, lineCase.volts);
+		if (!solver.SetHints(points.data(), points.data(), volts.data(), volts.data()))
+		{
+			std::cerr << "[WARNING]\tSkipping illegal line case " << lineCase.fields << "/" << lineCase.points << "/" << lineCase.volts << "." << std::endl;
+			continue;
+		}
+
+		std::string name = std::to_string(lineCase.fields) + "f" + std::to_string(lineCase.points) + "p" + std::to_string(lineCase.volts) + "v";
+
+		results.push_back(Measure("line", name, options.samples, 0,
+			[&solver]()
+			{
+				solver.SolveSingleLine(0, true, false);
+			}));
+
+		results.push_back(Measure("line", name + "/cached", options.samples, 0,
+			[&solver]()
+			{
+				solver.SolveSingleLine(0, true, true);
+			}));
+	}
+}
+
+static void RunGameBenchmarks(const BenchOptions& options, std::vector<BenchResult>& results)
+{
+	std::vector<Corpus> corpora;
+	corpora.push_back(CreateLevelCorpus(options.seed, options.gameCount));
+	corpora.push_back(CreateRandomCorpus(options.seed, 8, 8, options.gameCount));
+	corpora.push_back(CreateRandomCorpus(options.seed, 16, 16, std::max(options.gameCount / 10, 1U)));
+
+	for (const Corpus& corpus : corpora)
+	{
+		//	Construct the solver once, like VFBatch, so the replays do not include the lookup.
+		VF::Solver solver(corpus.rows, corpus.columns);
+
+		//	Every sample replays the whole corpus, the result is the time per board.
+		results.push_back(Measure("game", corpus.name, options.samples, (unsigned int)corpus.boards.size(),
+			[&solver, &corpus, board = size_t(0)]() mutable
+			{
+				ReplayBoard(solver, corpus.boards[board], corpus.rows);
+				board = (board + 1) % corpus.boards.size();
+			}));
+	}
+
+	//	The same replays on the solvers specialized for the dimensions.
+	auto measureFixed = [&options, &results](const Corpus& corpus, auto& solver)
+	{
+		results.push_back(Measure("game", corpus.name + "-fixed", options.samples, (unsigned int)corpus.boards.size(),
+			[&solver, &corpus, board = size_t(0)]() mutable
+			{
+				ReplayBoard(solver, corpus.boards[board], corpus.rows);
+				board = (board + 1) % corpus.boards.size();
+			}));
+	};
+
+	VF::FixedSolver<VF::GAME_ROWS, VF::GAME_COLUMNS> gameSolver;
+	measureFixed(corpora[0], gameSolver);
+
+	VF::FixedSolver<8, 8> solver8x8;
+	measureFixed(corpora[1], solver8x8);
+}
+
+//	Types of a memo in the order of their bits, see VF::Solver::MEMO_TYPE.
+static constexpr unsigned int TYPE_POINTS[] = { 1, 2, 3, 0 };
+static constexpr unsigned int TYPE_VOLTS[] = { 0, 0, 0, 1 };
+
+//	Adds the types of every arrangement of fields[i..] within their memos that adds up to pointsLeft and voltsLeft to allowed.
+static bool CollectLineArrangements(const std::vector<unsigned char>& memos, const unsigned int* fields, unsigned int count, unsigned int i,
+	unsigned int pointsLeft, unsigned int voltsLeft, unsigned char* types, unsigned char* allowed)
+{
+	unsigned int fieldsLeft = count - i;
+	if (voltsLeft > fieldsLeft || pointsLeft < fieldsLeft - voltsLeft || pointsLeft > (fieldsLeft - voltsLeft) * 3)
+		return false;
+
+	if (fieldsLeft == 0)
+	{
+		for (unsigned int j = 0; j < count; j++)
+			allowed[j] |= types[j];
+		return true;
+	}
+
+	bool isLegal = false;
+	for (unsigned int type = 0; type < 4; type++)
+	{
+		if (!(memos[fields[i]] & (1 << type)) || TYPE_POINTS[type] > pointsLeft || TYPE_VOLTS[type] > voltsLeft)
+			continue;
+
+		types[i] = (unsigned char)(1 << type);
+		isLegal |= CollectLineArrangements(memos, fields, count, i + 1, pointsLeft - TYPE_POINTS[type], voltsLeft - TYPE_VOLTS[type], types, allowed);
+	}
+	return isLegal;
+}
+
+//	Reference for the verify group: narrows every line to the types its fields take in some arrangement that matches its hints, tried one by one,
+//	until no line changes. This is the fixpoint every incremental solve has to reach. Returns false on a contradiction.
+static bool SolveReference(const CorpusBoard& board, unsigned int rows, unsigned int columns, std::vector<unsigned char>& memos)
+{
+	std::vector<unsigned int> fields(std::max(rows, columns));
+	std::vector<unsigned char> types(fields.size());
+	std::vector<unsigned char> allowed(fields.size());
+
+	bool isChanged = true;
+	while (isChanged)
+	{
+		isChanged = false;
+		for (unsigned int line = 0; line < columns + rows; line++)
+		{
+			bool isColumn = line < columns;
+			unsigned int index = isColumn ? line : line - columns;
+			unsigned int count = isColumn ? rows : columns;
+			for (unsigned int i = 0; i < count; i++)
+				fields[i] = isColumn ? index * rows + i : i * rows + index;
+
+			std::fill(allowed.begin(), allowed.end(), 0);
+			unsigned int points = isColumn ? board.uPoint[index] : board.vPoint[index];
+			unsigned int volts = isColumn ? board.uVolt[index] : board.vVolt[index];
+			if (!CollectLineArrangements(memos, fields.data(), count, 0, points, volts, types.data(), allowed.data()))
+				return false;
+
+			for (unsigned int i = 0; i < count; i++)
+			{
+				unsigned char memo = memos[fields[i]] & (allowed[i] | VF::Solver::MEMO_CONF);
+				if (std::popcount((unsigned int)(memo & 0x0F)) == 1)
+					memo |= VF::Solver::MEMO_CONF;
+				if (memo != memos[fields[i]])
+				{
+					memos[fields[i]] = memo;
+					isChanged = true;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+//	Compares the memos and user-confirmed fields of two solvers, returns whether they are equal.
+template <typename SolverA, typename SolverB>
+static bool IsSameBoard(const SolverA& a, const SolverB& b, unsigned int rows, unsigned int columns)
+{
+	for (unsigned int u = 0; u < columns; u++)
+	{
+		for (unsigned int v = 0; v < rows; v++)
+		{
+			if (a.GetMemo(u, v) != b.GetMemo(u, v) || a.IsMemoUserConfirmed(u, v) != b.IsMemoUserConfirmed(u, v))
+				return false;
+		}
+	}
+	return true;
+}
+
+static bool ReportVerify(const std::string& name, unsigned long long actionCount, unsigned long long mismatchCount)
+{
+	std::cerr << (mismatchCount ? "[ERROR]\t" : "[INFO]\t") << "verify " << name << ": " << mismatchCount << " of " << actionCount << " actions mismatched." << std::endl;
+	return mismatchCount == 0;
+}
+
+//	Sets the right memos in random order, with some of them unset again and set later, and compares every step with the reference fixpoint of the
+//	memos set so far. Covers the line solvers, the propagation and the rollback of UnsetMemo() against a solve from scratch.
+static bool VerifyFixpoint(const BenchOptions& options, const Corpus& corpus)
+{
+	VF::Solver solver(corpus.rows, corpus.columns);
+	unsigned long long actionCount = 0;
+	unsigned long long mismatchCount = 0;
+
+	for (size_t b = 0; b < corpus.boards.size(); b++)
+	{
+		const CorpusBoard& board = corpus.boards[b];
+		std::mt19937_64 rng(MixSeed(options.seed ^ 0x5645524946590000ULL, b));
+
+		solver.ResetBoard();
+		if (!solver.SetHints(board.uPoint.data(), board.vPoint.data(), board.uVolt.data(), board.vVolt.data()))
+			continue;
+
+		std::vector<unsigned int> pending(board.order.rbegin(), board.order.rend());
+		std::vector<unsigned int> confirmed;
+		while (!pending.empty())
+		{
+			if (!confirmed.empty() && Draw(rng, 4) == 0)
+			{
+				unsigned int i = Draw(rng, (unsigned int)confirmed.size());
+				unsigned int field = confirmed[i];
+				confirmed.erase(confirmed.begin() + i);
+				pending.insert(pending.begin() + Draw(rng, (unsigned int)pending.size() + 1), field);
+				solver.UnsetMemo(field / corpus.rows, field % corpus.rows);
+			}
+			else
+			{
+				unsigned int field = pending.back();
+				pending.pop_back();
+				confirmed.push_back(field);
+				solver.SetMemo(field / corpus.rows, field % corpus.rows, board.values[field]);
+			}
+			actionCount++;
+
+			std::vector<unsigned char> memos(corpus.rows * corpus.columns, VF::Solver::MEMO_1 | VF::Solver::MEMO_2 | VF::Solver::MEMO_3 | VF::Solver::MEMO_VOLT);
+			for (unsigned int field : confirmed)
+				memos[field] = board.values[field] | VF::Solver::MEMO_CONF;
+			bool isSame = SolveReference(board, corpus.rows, corpus.columns, memos);
+			for (unsigned int field = 0; isSame && field < memos.size(); field++)
+			{
+				bool isUserConf = std::find(confirmed.begin(), confirmed.end(), field) != confirmed.end();
+				isSame = solver.GetMemo(field / corpus.rows, field % corpus.rows) == memos[field] && solver.IsMemoUserConfirmed(field / corpus.rows, field % corpus.rows) == isUserConf;
+			}
+			if (!isSame)
+			{
+				mismatchCount++;
+				break;
+			}
+		}
+	}
+
+	return ReportVerify("fixpoint " + corpus.name, actionCount, mismatchCount);
+}
+
+//	Plays the same random right, wrong and unset memos on two solvers and compares them after every step. Wrong memos exercise the withdrawal of
+//	contradictory memos, and unsets after them the solve from scratch.
+template <typename SolverA, typename SolverB>
+static bool VerifyEqual(const BenchOptions& options, const Corpus& corpus, const std::string& name, SolverA& a, SolverB& b, unsigned int stepCount)
+{
+	unsigned long long actionCount = 0;
+	unsigned long long mismatchCount = 0;
+
+	for (size_t i = 0; i < corpus.boards.size(); i++)
+	{
+		const CorpusBoard& board = corpus.boards[i];
+		std::mt19937_64 rng(MixSeed(options.seed ^ 0x455155414C000000ULL, i));
+
+		a.ResetBoard();
+		b.ResetBoard();
+		bool isLegal = a.SetHints(board.uPoint.data(), board.vPoint.data(), board.uVolt.data(), board.vVolt.data());
+		actionCount++;
+		if (isLegal != b.SetHints(board.uPoint.data(), board.vPoint.data(), board.uVolt.data(), board.vVolt.data()) || !IsSameBoard(a, b, corpus.rows, corpus.columns))
+		{
+			mismatchCount++;
+			continue;
+		}
+
+		for (unsigned int step = 0; step < stepCount; step++)
+		{
+			unsigned int u = Draw(rng, corpus.columns);
+			unsigned int v = Draw(rng, corpus.rows);
+			unsigned int action = Draw(rng, 10);
+			if (action < 2)
+			{
+				a.UnsetMemo(u, v);
+				b.UnsetMemo(u, v);
+			}
+			else
+			{
+				VF::Solver::MEMO_TYPE memo = action < 5 ? (VF::Solver::MEMO_TYPE)(1 << Draw(rng, 4)) : board.values[u * corpus.rows + v];
+				a.SetMemo(u, v, memo);
+				b.SetMemo(u, v, memo);
+			}
+			actionCount++;
+
+			if (!IsSameBoard(a, b, corpus.rows, corpus.columns))
+			{
+				mismatchCount++;
+				break;
+			}
+		}
+	}
+
+	return ReportVerify(name + " " + corpus.name, actionCount, mismatchCount);
+}
+
+static bool RunVerifyChecks(const BenchOptions& options)
+{
+	Corpus levels = CreateLevelCorpus(options.seed, options.gameCount);
+	Corpus random6x7 = CreateRandomCorpus(options.seed, 6, 7, std::max(options.gameCount / 4, 1U));
+	Corpus random8x8 = CreateRandomCorpus(options.seed, 8, 8, std::max(options.gameCount / 4, 1U));
+	Corpus random16x16 = CreateRandomCorpus(options.seed, 16, 16, std::max(options.gameCount / 10, 1U));
+
+	bool isPassed = true;
+	isPassed &= VerifyFixpoint(options, levels);
+	isPassed &= VerifyFixpoint(options, random6x7);
+	isPassed &= VerifyFixpoint(options, random8x8);
+
+	//	The specialized solvers have to give the same memos as VF::Solver.
+	{
+		VF::Solver solver(levels.rows, levels.columns);
+		VF::FixedSolver<VF::GAME_ROWS, VF::GAME_COLUMNS> fixedSolver;
+		isPassed &= VerifyEqual(options, levels, "fixed", solver, fixedSolver, 20);
+	}
+	{
+		VF::Solver solver(8, 8);
+		VF::FixedSolver<8, 8> fixedSolver;
+		isPassed &= VerifyEqual(options, random8x8, "fixed", solver, fixedSolver, 30);
+	}
+
+	//	The parallel line engine has to reach the same memos as a single thread.
+	{
+		VF::Solver serialSolver(16, 16);
+		VF::Solver parallelSolver(16, 16);
+		parallelSolver.SetThreadCount(4);
+		isPassed &= VerifyEqual(options, random16x16, "parallel", serialSolver, parallelSolver, 60);
+	}
+
+	return isPassed;
+}
+
+static void WriteJson(std::ostream& output, const std::vector<BenchResult>& results)
+{
+	output << "{\n\t\"unit\": \"ns\",\n\t\"benchmarks\": [\n";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchResult& result = results[i];
+		output << "\t\t{ \"group\": \"" << result.group << "\", \"name\": \"" << result.name << "\", \"samples\": " << result.samples <<
+			", \"min\": " << result.min << ", \"median\": " << result.median << ", \"p99\": " << result.p99 << " }" <<
+			(i + 1 < results.size() ? ",\n" : "\n");
+	}
+	output << "\t]\n}\n";
+}
+
+static void WriteCsv(std::ostream& output, const std::vector<BenchResult>& results)
+{
+	output << "group,name,samples,min_ns,median_ns,p99_ns\n";
+	for (const BenchResult& result : results)
+		output << result.group << "," << result.name << "," << result.samples << "," << result.min << "," << result.median << "," << result.p99 << "\n";
+}
+
+static void PrintUsage()
+{
+	std::cerr <<
+		"Usage: VFBench [-r samples] [-n games] [-s seed] [-c cases] [-g group] [-f json|csv] [-o output]\n"
+		"  Times solver construction, single lines and game replays, and writes min/median/p99 in ns to output (or stdout).\n"
+		"  group is one of: construct line game (default all).\n"
+		"  -g verify compares the solvers against references instead and exits with 1 on a mismatch.\n";
+}
+
+int main(int argc, char** argv)
+{
+	BenchOptions options;
+	bool isCsv = false;
+	const char* outputPath = nullptr;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if ((arg == "-r" || arg == "-n" || arg == "-s") && i + 1 < argc)
+		{
+			const char* value = argv[++i];
+			unsigned long long number = 0;
+			auto [end, error] = std::from_chars(value, value + std::strlen(value), number);
+			if (error != std::errc() || *end != '\0' || (arg != "-s" && (number == 0 || number > 1000000)))
+			{
+				PrintUsage();
+				return 1;
+			}
+
+			if (arg == "-r")
+				options.samples = (unsigned int)number;
+			else if (arg == "-n")
+				options.gameCount = (unsigned int)number;
+			else
+				options.seed = number;
+		}
+		else if ((arg == "-c" || arg == "-g" || arg == "-f" || arg == "-o") && i + 1 < argc)
+		{
+			const char* value = argv[++i];
+			if (arg == "-c")
+				options.casesPath = value;
+			else if (arg == "-g")
+				options.group = value;
+			else if (arg == "-o")
+				outputPath = value;
+			else if (std::string(value) == "csv" || std::string(value) == "json")
+				isCsv = std::string(value) == "csv";
+			else
+			{
+				PrintUsage();
+				return 1;
+			}
+		}
+		else if (arg == "-h" || arg == "--help")
+		{
+			PrintUsage();
+			return 0;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (options.group && std::string(options.group) == "verify")
+	{
+		auto startTime = std::chrono::steady_clock::now();
+		bool isPassed = RunVerifyChecks(options);
+		std::cerr << "[INFO]\tRan the verify checks in " << std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count() << " s." << std::endl;
+		return isPassed ? 0 : 1;
+	}
+
+	struct Group
+	{
+		const char* name;
+		void (*run)(const BenchOptions& options, std::vector<BenchResult>& results);
+	};
+
+	static constexpr Group GROUPS[] =
+	{
+		{ "construct", RunConstructBenchmarks },
+		{ "line", RunLineBenchmarks },
+		{ "game", RunGameBenchmarks }
+	};
+
+	std::vector<BenchResult> results;
+	bool isGroupFound = false;
+	for (const Group& group : GROUPS)
+	{
+		if (options.group && std::string(options.group) != group.name)
+			continue;
+
+		isGroupFound = true;
+		auto startTime = std::chrono::steady_clock::now();
+		group.run(options, results);
+		std::cerr << "[INFO]\tRan the " << group.name << " benchmarks in " <<
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count() << " s." << std::endl;
+	}
+
+	if (!isGroupFound)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	std::ofstream outputFile;
+	if (outputPath)
+	{
+		outputFile.open(outputPath);
+		if (!outputFile)
+		{
+			std::cerr << "[ERROR]\tCould not open output file " << outputPath << "." << std::endl;
+			return 1;
+		}
+	}
+	std::ostream& output = outputFile.is_open() ? outputFile : std::cout;
+
+	if (isCsv)
+		WriteCsv(output, results);
+	else
+		WriteJson(output, results);
+
+	return 0;
+}
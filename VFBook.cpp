@@ -0,0 +1,349 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include <random>
+#include <algorithm>
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "VF/Solver.h"
+#include "VF/FixedSolver.h"
+#include "VF/GameLevels.h"
+#include "VF/MoveSearch.h"
+#include "VF/OpeningBook.h"
+#include "VF/WorkerPool.h"
+
+//	Opening book builder.
+//
+//	Draws random boards from the HG/SS level configurations like VFSimulate, collects the distinct canonical hints of the boards (see VF/OpeningBook.h)
+//	and searches the best first move of every one that is not in the book yet with VF::MoveSearch, on a pool of worker threads.
+//
+//	Finished entries are appended to a journal next to the book (<book>.journal) as they come in, so an interrupted build resumes where it stopped.
+//	At the end the book is rewritten with its old entries, the journal and the new entries, and the journal is removed. Running it again with more
+//	boards or another seed extends an existing book.
+
+//	SplitMix64, turns the seed and the index of a board into a well-mixed seed for the RNG of that board.
+static uint64_t MixSeed(uint64_t seed, uint64_t board)
+{
+	uint64_t z = seed + (board + 1) * 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+//	Draws a number below bound, the same with every standard library.
+static unsigned int Draw(std::mt19937_64& rng, unsigned int bound)
+{
+	return (unsigned int)(rng() % bound);
+}
+
+//	Draws a board of a random level and configuration like the game, and gets the canonical form of its hints.
+static VF::OpeningBook::CanonicalHints DrawHints(uint64_t seed, uint64_t board)
+{
+	std::mt19937_64 rng(MixSeed(seed, board));
+	const VF::LevelConfig& config = VF::LEVEL_CONFIGS[Draw(rng, VF::LEVEL_COUNT)][Draw(rng, VF::LEVEL_CONFIG_COUNT)];
+
+	const unsigned int fieldCount = VF::GAME_ROWS * VF::GAME_COLUMNS;
+	VF::Solver::MEMO_TYPE values[fieldCount];
+	unsigned int field = 0;
+	for (unsigned int i = 0; i < config.twos; i++)
+		values[field++] = VF::Solver::MEMO_2;
+	for (unsigned int i = 0; i < config.threes; i++)
+		values[field++] = VF::Solver::MEMO_3;
+	for (unsigned int i = 0; i < config.volts; i++)
+		values[field++] = VF::Solver::MEMO_VOLT;
+	while (field < fieldCount)
+		values[field++] = VF::Solver::MEMO_1;
+
+	//	Fisher-Yates shuffle
+	for (unsigned int i = fieldCount - 1; i > 0; i--)
+		std::swap(values[i], values[Draw(rng, i + 1)]);
+
+	unsigned int uPoint[VF::GAME_COLUMNS] = {};
+	unsigned int uVolt[VF::GAME_COLUMNS] = {};
+	unsigned int vPoint[VF::GAME_ROWS] = {};
+	unsigned int vVolt[VF::GAME_ROWS] = {};
+	for (unsigned int u = 0; u < VF::GAME_COLUMNS; u++)
+	{
+		for (unsigned int v = 0; v < VF::GAME_ROWS; v++)
+		{
+			VF::Solver::MEMO_TYPE value = values[u * VF::GAME_ROWS + v];
+			unsigned int points = value == VF::Solver::MEMO_1 ? 1 : value == VF::Solver::MEMO_2 ? 2 : value == VF::Solver::MEMO_3 ? 3 : 0;
+			uPoint[u] += points;
+			vPoint[v] += points;
+			uVolt[u] += value == VF::Solver::MEMO_VOLT;
+			vVolt[v] += value == VF::Solver::MEMO_VOLT;
+		}
+	}
+
+	return VF::OpeningBook::Canonicalize(VF::GAME_ROWS, VF::GAME_COLUMNS, uPoint, vPoint, uVolt, vVolt);
+}
+
+//	Reads the entries of a journal, which is a book header followed by entries in the order they were searched, dropping a record cut off by an
+//	interrupted write. hasHeader is set if the journal exists and starts with a header. Returns false if the journal is of another board size or book version.
+static bool ReadJournal(const std::string& path, std::vector<VF::OpeningBook::Entry>& entries, bool& hasHeader)
+{
+	hasHeader = false;
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return true;
+
+	VF::OpeningBook::Header header {};
+	VF::OpeningBook::Header expected = VF::OpeningBook::CreateHeader(VF::GAME_ROWS, VF::GAME_COLUMNS, 0);
+	if (!file.read((char*)&header, sizeof(header)))
+		return true;
+	if (std::memcmp(&header, &expected, sizeof(header)) != 0)
+		return false;
+	hasHeader = true;
+
+	VF::OpeningBook::Entry entry;
+	while (file.read((char*)&entry, sizeof(entry)))
+		entries.push_back(entry);
+	return true;
+}
+
+//	Gets the canonical hints of an entry as a string, to tell hints apart whose keys collide.
+static std::string GetHintsId(const unsigned char* lines)
+{
+	return std::string((const char*)lines, 2 * VF::OpeningBook::MAX_DIM);
+}
+
+static void PrintUsage()
+{
+	std::cerr <<
+		"Usage: VFBook -o book [-n boards] [-s seed] [-j threads] [-b boardLimit] [-m nodeLimit]\n"
+		"  Draws random HG/SS boards and adds the best first move of their hints to the book, resuming an interrupted build.\n"
+		"  boardLimit and nodeLimit are the limits of the move search (default 2000000 and 20000000), see VF::MoveSearch::SetLimits().\n";
+}
+
+int main(int argc, char** argv)
+{
+	unsigned long long boardCount = 10000;
+	unsigned long long seed = 0;
+	unsigned int threadCount = std::thread::hardware_concurrency();
+	unsigned long long boardLimit = 2000000;
+	unsigned long long nodeLimit = 20000000;
+	std::string bookPath;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "-o" && i + 1 < argc)
+		{
+			bookPath = argv[++i];
+		}
+		else if ((arg == "-n" || arg == "-s" || arg == "-j" || arg == "-b" || arg == "-m") && i + 1 < argc)
+		{
+			const char* value = argv[++i];
+			unsigned long long number = 0;
+			auto [end, error] = std::from_chars(value, value + std::strlen(value), number);
+			if (error != std::errc() || *end != '\0' || (arg == "-j" && (number == 0 || number > 1024)))
+			{
+				PrintUsage();
+				return 1;
+			}
+
+			if (arg == "-n")
+				boardCount = number;
+			else if (arg == "-s")
+				seed = number;
+			else if (arg == "-j")
+				threadCount = (unsigned int)number;
+			else if (arg == "-b")
+				boardLimit = number;
+			else
+				nodeLimit = number;
+		}
+		else if (arg == "-h" || arg == "--help")
+		{
+			PrintUsage();
+			return 0;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (bookPath.empty())
+	{
+		PrintUsage();
+		return 1;
+	}
+	if (threadCount == 0)
+		threadCount = 1;
+
+	auto start = std::chrono::steady_clock::now();
+
+	//	1. Entries that are already done: those of the book and those of the journal of an interrupted build.
+	std::vector<VF::OpeningBook::Entry> entries;
+	{
+		VF::OpeningBook book;
+		if (book.Open(bookPath.c_str()))
+		{
+			if (book.GetRowCount() != VF::GAME_ROWS || book.GetColumnCount() != VF::GAME_COLUMNS)
+			{
+				std::cerr << "[ERROR]\tThe book " << bookPath << " is not for boards of " << VF::GAME_ROWS << "x" << VF::GAME_COLUMNS << "." << std::endl;
+				return 1;
+			}
+			entries.assign(book.GetEntries(), book.GetEntries() + book.GetEntryCount());
+		}
+		else if (std::filesystem::exists(bookPath))
+		{
+			//	Rewriting it would drop its entries, e.g. those of a book of an older version.
+			std::cerr << "[ERROR]\tThe book " << bookPath << " could not be read, or is of another book version." << std::endl;
+			return 1;
+		}
+	}
+
+	std::string journalPath = bookPath + ".journal";
+	size_t bookEntryCount = entries.size();
+	bool hasJournal = false;
+	if (!ReadJournal(journalPath, entries, hasJournal))
+	{
+		std::cerr << "[ERROR]\tThe journal " << journalPath << " is not for boards of " << VF::GAME_ROWS << "x" << VF::GAME_COLUMNS << " or of another book version." << std::endl;
+		return 1;
+	}
+	size_t journalEntryCount = entries.size() - bookEntryCount;
+
+	std::unordered_set<std::string> doneHints;
+	for (const VF::OpeningBook::Entry& entry : entries)
+		doneHints.insert(GetHintsId(entry.lines));
+
+	//	2. Distinct canonical hints of the drawn boards that are not done yet, in the order they were drawn.
+	std::vector<VF::OpeningBook::CanonicalHints> pending;
+	std::unordered_map<std::string, unsigned long long> drawnHints;
+	for (unsigned long long board = 0; board < boardCount; board++)
+	{
+		VF::OpeningBook::CanonicalHints hints = DrawHints(seed, board);
+		std::string id = GetHintsId(hints.lines);
+		if (drawnHints[id]++ == 0 && !doneHints.count(id))
+			pending.push_back(hints);
+	}
+
+	std::cerr << "[INFO]\t" << boardCount << " boards with " << drawnHints.size() << " distinct hints, " << bookEntryCount << " entries in the book, "
+		<< journalEntryCount << " in the journal, " << pending.size() << " to search." << std::endl;
+
+	//	3. Search the pending hints, appending every entry to the journal as soon as it is done.
+	std::ofstream journal;
+	if (!pending.empty())
+	{
+		//	An interrupted write may have left part of a record, which would shift every later record.
+		std::error_code error;
+		if (hasJournal)
+			std::filesystem::resize_file(journalPath, sizeof(VF::OpeningBook::Header) + journalEntryCount * sizeof(VF::OpeningBook::Entry), error);
+
+		journal.open(journalPath, std::ios::binary | (hasJournal ? std::ios::app : std::ios::trunc));
+		if (!hasJournal)
+		{
+			VF::OpeningBook::Header header = VF::OpeningBook::CreateHeader(VF::GAME_ROWS, VF::GAME_COLUMNS, 0);
+			journal.write((const char*)&header, sizeof(header));
+			journal.flush();
+		}
+		if (error || !journal)
+		{
+			std::cerr << "[ERROR]\tCould not open the journal " << journalPath << "." << std::endl;
+			return 1;
+		}
+	}
+
+	VF::WorkerPool pool(threadCount);
+	std::vector<VF::FixedSolver<VF::GAME_ROWS, VF::GAME_COLUMNS>> solvers(pool.GetWorkerCount());
+	std::vector<std::unique_ptr<VF::MoveSearch>> searches;
+	for (unsigned int i = 0; i < pool.GetWorkerCount(); i++)
+	{
+		searches.push_back(std::make_unique<VF::MoveSearch>(VF::GAME_ROWS, VF::GAME_COLUMNS));
+		searches.back()->SetLimits((size_t)boardLimit, (size_t)nodeLimit);
+	}
+
+	std::mutex journalMutex;
+	std::atomic<unsigned int> doneCount = 0;
+	std::atomic<unsigned int> exactCount = 0;
+	bool isJournalBroken = false;
+
+	pool.Run((unsigned int)pending.size(), [&](unsigned int index, unsigned int worker)
+	{
+		const VF::OpeningBook::CanonicalHints& hints = pending[index];
+
+		//	The memos of a board with nothing revealed only follow from the hints.
+		VF::FixedSolver<VF::GAME_ROWS, VF::GAME_COLUMNS>& solver = solvers[worker];
+		solver.ResetBoard();
+		solver.SetHints(hints.uPoint, hints.vPoint, hints.uVolt, hints.vVolt);
+
+		unsigned char memos[VF::GAME_ROWS * VF::GAME_COLUMNS];
+		bool revealed[VF::GAME_ROWS * VF::GAME_COLUMNS] = {};
+		for (unsigned int u = 0; u < hints.columns; u++)
+		{
+			for (unsigned int v = 0; v < hints.rows; v++)
+				memos[u * hints.rows + v] = solver.GetMemo(u, v);
+		}
+
+		VF::MoveSearch::Result result = searches[worker]->FindBestMove(hints.uPoint, hints.vPoint, hints.uVolt, hints.vVolt, memos, revealed);
+
+		VF::OpeningBook::Entry entry {};
+		entry.key = hints.key;
+		std::memcpy(entry.lines, hints.lines, sizeof(entry.lines));
+		entry.winProbability = (float)result.winProbability;
+		entry.column = (unsigned char)result.column;
+		entry.row = (unsigned char)result.row;
+		entry.flags = (result.isValid ? VF::OpeningBook::ENTRY_VALID : 0) | (result.isExact ? VF::OpeningBook::ENTRY_EXACT : 0);
+
+		std::lock_guard<std::mutex> lock(journalMutex);
+		journal.write((const char*)&entry, sizeof(entry));
+		journal.flush();
+		isJournalBroken |= !journal;
+		entries.push_back(entry);
+
+		exactCount += result.isExact;
+		unsigned int done = ++doneCount;
+		if (done % 100 == 0 || done == pending.size())
+			std::cerr << "[INFO]\tSearched " << done << "/" << pending.size() << " hints." << std::endl;
+	});
+
+	if (isJournalBroken)
+	{
+		std::cerr << "[ERROR]\tCould not write the journal " << journalPath << "." << std::endl;
+		return 1;
+	}
+	journal.close();
+
+	//	4. Rewrite the book with every entry, only then the journal is not needed anymore.
+	if (!VF::OpeningBook::Write(bookPath.c_str(), VF::GAME_ROWS, VF::GAME_COLUMNS, entries))
+	{
+		std::cerr << "[ERROR]\tCould not write the book " << bookPath << "." << std::endl;
+		return 1;
+	}
+	std::error_code error;
+	std::filesystem::remove(journalPath, error);
+
+	//	Share of the drawn boards the book answers, i.e. how often a game starts on a position of the book.
+	unsigned long long coveredBoards = 0;
+	std::unordered_set<std::string> bookHints;
+	for (const VF::OpeningBook::Entry& entry : entries)
+		bookHints.insert(GetHintsId(entry.lines));
+	for (const auto& [id, count] : drawnHints)
+	{
+		if (bookHints.count(id))
+			coveredBoards += count;
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cerr << "[INFO]\tWrote " << entries.size() << " entries to " << bookPath << " in " << seconds << " s on " << pool.GetWorkerCount() << " threads, "
+		<< exactCount << "/" << pending.size() << " new searches exact." << std::endl;
+	std::cout << "entries\t" << entries.size() << "\n";
+	std::cout << "searched\t" << pending.size() << "\n";
+	std::cout << "coverage\t" << (boardCount ? (double)coveredBoards / boardCount : 0.0) << "\n";
+
+	return 0;
+}
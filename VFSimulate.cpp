@@ -0,0 +1,455 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include <random>
+#include <algorithm>
+
+#include "VF/Solver.h"
+#include "VF/BoardCounter.h"
+#include "VF/FixedSolver.h"
+#include "VF/GameLevels.h"
+#include "VF/MoveSearch.h"
+#include "VF/OpeningBook.h"
+
+//	Monte Carlo simulator.
+//
+//	Draws random boards from the HG/SS level configurations (see VF/GameLevels.h), derives the hints the game would show,
+//	and plays every board through a VF::Solver with a move-selection policy until it is cleared or a volt is flipped. Policies that only use the memos
+//	play on the VF::FixedSolver of the game size instead, which gives the same memos.
+//	Reports the win rate and average coins per level, and the throughput on stderr.
+//
+//	Every game draws its board from an RNG seeded with the seed and the index of the game, so the results for a seed
+//	do not depend on the count of threads, and two policies run with the same seed play the same boards.
+
+struct Move
+{
+	bool isValid;
+	unsigned int column;
+	unsigned int row;
+};
+
+using GameSolver = VF::FixedSolver<VF::GAME_ROWS, VF::GAME_COLUMNS>;
+
+//	Picks the next field to flip. Must not return a field that was already flipped, i.e. one that is user-confirmed.
+using Policy = Move (*)(const VF::Solver& solver);
+using GamePolicy = Move (*)(const GameSolver& solver);
+
+static bool IsUsefulMemo(unsigned char memo)
+{
+	return memo & (VF::Solver::MEMO_2 | VF::Solver::MEMO_3);
+}
+
+//	Flips a field that is known to be no volt if there is one, otherwise the first field that could be a 2 or 3. Only uses the memos.
+template <typename SolverType>
+static Move PolicyMemo(const SolverType& solver)
+{
+	Move fallback { false, 0, 0 };
+	for (unsigned int u = 0; u < solver.GetColumnCount(); u++)
+	{
+		for (unsigned int v = 0; v < solver.GetRowCount(); v++)
+		{
+			unsigned char memo = solver.GetMemo(u, v);
+			if (solver.IsMemoUserConfirmed(u, v) || !IsUsefulMemo(memo))
+				continue;
+
+			if (!(memo & VF::Solver::MEMO_VOLT))
+				return Move { true, u, v };
+			if (!fallback.isValid)
+				fallback = Move { true, u, v };
+		}
+	}
+	return fallback;
+}
+
+//	Flips the field least likely to be a volt among those that could be a 2 or 3, according to the exact board probabilities.
+static Move PolicySafest(const VF::Solver& solver)
+{
+	unsigned int columns = solver.GetColumnCount();
+	unsigned int rows = solver.GetRowCount();
+
+	double probabilities[VF::GAME_ROWS * VF::GAME_COLUMNS * VF::BoardCounter::VALUE_COUNT];
+	std::vector<double> probabilitiesLarge;
+	double* p = probabilities;
+	if (columns * rows > VF::GAME_ROWS * VF::GAME_COLUMNS)
+	{
+		probabilitiesLarge.resize(columns * rows * VF::BoardCounter::VALUE_COUNT);
+		p = probabilitiesLarge.data();
+	}
+
+	Move move { false, 0, 0 };
+	if (!solver.GetProbabilities(p))
+		return PolicyMemo(solver);
+
+	double bestSafe = -1.0;
+	double bestUseful = -1.0;
+	for (unsigned int u = 0; u < columns; u++)
+	{
+		for (unsigned int v = 0; v < rows; v++)
+		{
+			if (solver.IsMemoUserConfirmed(u, v))
+				continue;
+
+			const double* fieldProbabilities = p + (u * rows + v) * VF::BoardCounter::VALUE_COUNT;
+			double useful = fieldProbabilities[VF::BoardCounter::VALUE_2] + fieldProbabilities[VF::BoardCounter::VALUE_3];
+			double safe = 1.0 - fieldProbabilities[VF::BoardCounter::VALUE_VOLT];
+			if (useful <= 0.0)
+				continue;
+
+			if (safe > bestSafe || (safe == bestSafe && useful > bestUseful))
+			{
+				bestSafe = safe;
+				bestUseful = useful;
+				move = Move { true, u, v };
+			}
+		}
+	}
+	return move;
+}
+
+//	Flips the field that maximizes the probability to clear the board, see VF::MoveSearch.
+static Move PolicyBest(const VF::Solver& solver)
+{
+	VF::MoveSearch::Result result = solver.FindBestMove();
+	if (!result.isValid)
+		return PolicyMemo(solver);
+	return Move { true, result.column, result.row };
+}
+
+//	gamePolicy is set if the policy only needs the memos, and then used instead of policy.
+struct PolicyEntry
+{
+	const char* name;
+	Policy policy;
+	GamePolicy gamePolicy;
+};
+
+static constexpr PolicyEntry POLICIES[] =
+{
+	{ "memo", PolicyMemo<VF::Solver>, PolicyMemo<GameSolver> },
+	{ "safest", PolicySafest, nullptr },
+	{ "best", PolicyBest, nullptr }
+};
+
+struct LevelStats
+{
+	unsigned long long games = 0;
+	unsigned long long wins = 0;
+	unsigned long long coins = 0;
+	unsigned long long flips = 0;
+};
+
+//	SplitMix64, turns the seed and the index of a game into a well-mixed seed for the RNG of that game.
+static uint64_t MixSeed(uint64_t seed, uint64_t game)
+{
+	uint64_t z = seed + (game + 1) * 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+//	Draws a number below bound. The modulo bias is negligible for the small bounds used here, and unlike
+//	std::uniform_int_distribution the result is the same with every standard library.
+static unsigned int Draw(std::mt19937_64& rng, unsigned int bound)
+{
+	return (unsigned int)(rng() % bound);
+}
+
+//	Places the values of a configuration on the board in random order, column-major.
+static void GenerateBoard(std::mt19937_64& rng, const VF::LevelConfig& config, VF::Solver::MEMO_TYPE* values)
+{
+	const unsigned int fieldCount = VF::GAME_ROWS * VF::GAME_COLUMNS;
+
+	unsigned int field = 0;
+	for (unsigned int i = 0; i < config.twos; i++)
+		values[field++] = VF::Solver::MEMO_2;
+	for (unsigned int i = 0; i < config.threes; i++)
+		values[field++] = VF::Solver::MEMO_3;
+	for (unsigned int i = 0; i < config.volts; i++)
+		values[field++] = VF::Solver::MEMO_VOLT;
+	while (field < fieldCount)
+		values[field++] = VF::Solver::MEMO_1;
+
+	//	Fisher-Yates shuffle
+	for (unsigned int i = fieldCount - 1; i > 0; i--)
+		std::swap(values[i], values[Draw(rng, i + 1)]);
+}
+
+//	Plays one board until it is cleared or a volt is flipped, returns the coins won.
+template <typename SolverType>
+static unsigned int PlayGame(SolverType& solver, Move (*policy)(const SolverType& solver), const VF::Solver::MEMO_TYPE* values, LevelStats& stats)
+{
+	const unsigned int rows = VF::GAME_ROWS;
+	const unsigned int columns = VF::GAME_COLUMNS;
+
+	unsigned int uPoint[columns] = {};
+	unsigned int uVolt[columns] = {};
+	unsigned int vPoint[rows] = {};
+	unsigned int vVolt[rows] = {};
+
+	unsigned int usefulLeft = 0;
+	for (unsigned int u = 0; u < columns; u++)
+	{
+		for (unsigned int v = 0; v < rows; v++)
+		{
+			unsigned int points = 0;
+			switch (values[u * rows + v])
+			{
+			case VF::Solver::MEMO_1: points = 1; break;
+			case VF::Solver::MEMO_2: points = 2; usefulLeft++; break;
+			case VF::Solver::MEMO_3: points = 3; usefulLeft++; break;
+			default:
+				uVolt[u]++;
+				vVolt[v]++;
+				break;
+			}
+			uPoint[u] += points;
+			vPoint[v] += points;
+		}
+	}
+
+	solver.ResetBoard();
+	if (!solver.SetHints(uPoint, vPoint, uVolt, vVolt))
+		return 0;
+
+	unsigned int coins = 1;
+	while (usefulLeft)
+	{
+		Move move = policy(solver);
+		if (!move.isValid || move.column >= columns || move.row >= rows || solver.IsMemoUserConfirmed(move.column, move.row))
+			return 0;
+
+		stats.flips++;
+
+		VF::Solver::MEMO_TYPE value = values[move.column * rows + move.row];
+		switch (value)
+		{
+		case VF::Solver::MEMO_VOLT:
+			return 0;
+		case VF::Solver::MEMO_2:
+			coins *= 2;
+			usefulLeft--;
+			break;
+		case VF::Solver::MEMO_3:
+			coins *= 3;
+			usefulLeft--;
+			break;
+		default:
+			break;
+		}
+
+		solver.SetMemo(move.column, move.row, value);
+	}
+
+	return coins;
+}
+
+static void PrintUsage()
+{
+	std::cerr <<
+		"Usage: VFSimulate [-n games] [-l level] [-s seed] [-j threads] [-p policy] [-b book]\n"
+		"  Plays random HG/SS boards and reports the win rate and average coins of a policy.\n"
+		"  level is 1 to 8, or 0 to draw the level of every game at random (default 0).\n"
+		"  book is an opening book built by VFBook, the best policy looks its first move up there.\n"
+		"  policy is one of:";
+	for (const PolicyEntry& entry : POLICIES)
+		std::cerr << " " << entry.name;
+	std::cerr << " (default safest)\n";
+}
+
+int main(int argc, char** argv)
+{
+	unsigned long long gameCount = 100000;
+	unsigned long long seed = 0;
+	unsigned int level = 0;
+	unsigned int threadCount = std::thread::hardware_concurrency();
+	const PolicyEntry* policy = &POLICIES[1];
+	VF::OpeningBook book;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if ((arg == "-n" || arg == "-l" || arg == "-s" || arg == "-j" || arg == "-p") && i + 1 < argc)
+		{
+			const char* value = argv[++i];
+			if (arg == "-p")
+			{
+				policy = nullptr;
+				for (const PolicyEntry& entry : POLICIES)
+				{
+					if (std::strcmp(entry.name, value) == 0)
+						policy = &entry;
+				}
+				if (!policy)
+				{
+					PrintUsage();
+					return 1;
+				}
+				continue;
+			}
+
+			unsigned long long number = 0;
+			auto [end, error] = std::from_chars(value, value + std::strlen(value), number);
+			if (error != std::errc() || *end != '\0' ||
+				(arg == "-l" && number > VF::LEVEL_COUNT) || (arg == "-j" && (number == 0 || number > 1024)))
+			{
+				PrintUsage();
+				return 1;
+			}
+
+			if (arg == "-n")
+				gameCount = number;
+			else if (arg == "-l")
+				level = (unsigned int)number;
+			else if (arg == "-s")
+				seed = number;
+			else
+				threadCount = (unsigned int)number;
+		}
+		else if (arg == "-b" && i + 1 < argc)
+		{
+			const char* path = argv[++i];
+			if (!book.Open(path))
+			{
+				std::cerr << "[ERROR]\tCould not open the opening book " << path << "." << std::endl;
+				return 1;
+			}
+		}
+		else if (arg == "-h" || arg == "--help")
+		{
+			PrintUsage();
+			return 0;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (threadCount == 0)
+		threadCount = 1;
+
+	//	Workers take blocks of games from a shared counter, and keep their own statistics to avoid sharing cache lines.
+	const unsigned long long blockSize = 256;
+	std::atomic<unsigned long long> nextBlock = 0;
+	std::vector<std::vector<LevelStats>> threadStats(threadCount, std::vector<LevelStats>(VF::LEVEL_COUNT));
+	std::vector<VF::LineCache::Stats> threadCacheStats(threadCount);
+
+	auto work = [&](std::vector<LevelStats>& stats, VF::LineCache::Stats& cacheStats)
+	{
+		//	Only the solver the policy plays on is created.
+		std::unique_ptr<VF::Solver> solver;
+		std::unique_ptr<GameSolver> gameSolver;
+		if (policy->gamePolicy)
+			gameSolver = std::make_unique<GameSolver>();
+		else
+			solver = std::make_unique<VF::Solver>(VF::GAME_ROWS, VF::GAME_COLUMNS);
+		if (solver && book.IsOpen())
+			solver->SetOpeningBook(&book);
+		std::mt19937_64 rng;
+		VF::Solver::MEMO_TYPE values[VF::GAME_ROWS * VF::GAME_COLUMNS];
+
+		for (unsigned long long block = nextBlock++; block * blockSize < gameCount; block = nextBlock++)
+		{
+			unsigned long long end = std::min(gameCount, (block + 1) * blockSize);
+			for (unsigned long long game = block * blockSize; game < end; game++)
+			{
+				rng.seed(MixSeed(seed, game));
+
+				unsigned int gameLevel = level ? level - 1 : Draw(rng, VF::LEVEL_COUNT);
+				const VF::LevelConfig& config = VF::LEVEL_CONFIGS[gameLevel][Draw(rng, VF::LEVEL_CONFIG_COUNT)];
+				GenerateBoard(rng, config, values);
+
+				LevelStats& levelStats = stats[gameLevel];
+				unsigned int coins;
+				if (gameSolver)
+					coins = PlayGame(*gameSolver, policy->gamePolicy, values, levelStats);
+				else
+				{
+					//	The player knows the level, so the probabilities only consider the configurations the game picks from on it.
+					solver->SetGameLevel(gameLevel + 1);
+					coins = PlayGame(*solver, policy->policy, values, levelStats);
+				}
+				levelStats.games++;
+				levelStats.wins += coins != 0;
+				levelStats.coins += coins;
+			}
+		}
+
+		if (solver)
+			cacheStats = solver->GetLineCacheStats();
+	};
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> workers;
+	workers.reserve(threadCount - 1);
+	for (unsigned int t = 1; t < threadCount; t++)
+		workers.emplace_back(work, std::ref(threadStats[t]), std::ref(threadCacheStats[t]));
+	work(threadStats[0], threadCacheStats[0]);
+	for (std::thread& worker : workers)
+		worker.join();
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+	//	Merge in thread order, all counters are integers so the sums do not depend on which thread played which game.
+	std::vector<LevelStats> levelStats(VF::LEVEL_COUNT);
+	LevelStats total;
+	for (const std::vector<LevelStats>& stats : threadStats)
+	{
+		for (unsigned int l = 0; l < VF::LEVEL_COUNT; l++)
+		{
+			levelStats[l].games += stats[l].games;
+			levelStats[l].wins += stats[l].wins;
+			levelStats[l].coins += stats[l].coins;
+			levelStats[l].flips += stats[l].flips;
+		}
+	}
+
+	auto printStats = [](const char* name, const LevelStats& stats)
+	{
+		double games = stats.games ? (double)stats.games : 1.0;
+		std::cout << name << "\t" << stats.games << "\t" << stats.wins << "\t" <<
+			stats.wins / games << "\t" << stats.coins / games << "\t" << stats.flips / games << "\n";
+	};
+
+	std::cout << "policy " << policy->name << ", seed " << seed << "\n";
+	std::cout << "level\tgames\twins\twinRate\tavgCoins\tavgFlips\n";
+	for (unsigned int l = 0; l < VF::LEVEL_COUNT; l++)
+	{
+		if (!levelStats[l].games)
+			continue;
+
+		total.games += levelStats[l].games;
+		total.wins += levelStats[l].wins;
+		total.coins += levelStats[l].coins;
+		total.flips += levelStats[l].flips;
+
+		std::string name = std::to_string(l + 1);
+		printStats(name.c_str(), levelStats[l]);
+	}
+	printStats("all", total);
+	std::cout.flush();
+
+	std::cerr << "[INFO]\tPlayed " << gameCount << " games in " << seconds << " s (" <<
+		(seconds > 0.0 ? gameCount / seconds : 0.0) << " boards/s) on " << threadCount << " threads." << std::endl;
+
+	unsigned long long cacheHits = 0;
+	unsigned long long cacheMisses = 0;
+	for (const VF::LineCache::Stats& cacheStats : threadCacheStats)
+	{
+		cacheHits += cacheStats.hits;
+		cacheMisses += cacheStats.misses;
+	}
+	std::cerr << "[INFO]\tLine cache: " << cacheHits << " hits, " << cacheMisses << " misses (" <<
+		(cacheHits + cacheMisses ? 100.0 * cacheHits / (cacheHits + cacheMisses) : 0.0) << "% hits)." << std::endl;
+
+	return 0;
+}
@@ -1,6 +1,5 @@
 #include <iostream>
 #include <string>
-#include <format>
 
 #include "imgui.h"
 #include "imgui_impl_sdl2.h"
@@ -16,19 +15,50 @@
 #endif
 
 
-bool showDemoWindow = true;
+bool showDemoWindow = false;
 
+//	Count of frames still to draw before the main loop waits for the next event again. Dear ImGui needs a few frames
+//	after an input to settle its hover and active states.
+constexpr int FRAMES_AFTER_EVENT = 3;
+int framesToDraw = FRAMES_AFTER_EVENT;
 
-#include "VF\Solver.h"
+
+#include "VF\SolverThread.h"
 
 int columns = 5;
 int rows = 5;
-VF::Solver* p_Solver = nullptr;
+
+//	The board is solved on a thread of its own, the frame only queues the user actions and draws the latest finished board.
+VF::SolverThread* p_Solver = nullptr;
 unsigned int* uPoint = nullptr;
 unsigned int* vPoint = nullptr;
 unsigned int* uVolt = nullptr;
 unsigned int* vVolt = nullptr;
-bool isValidBoard = false;
+
+//	Event pushed by the solver thread whenever it finished a board, so that the main loop wakes up to draw it.
+Uint32 solvedEventType = (Uint32)-1;
+
+//	Labels of the memo buttons, the field is identified by the ID stack instead.
+static const char* GetMemoLabel(VF::Solver::MEMO_TYPE type)
+{
+	switch (type)
+	{
+	case VF::Solver::MEMO_1: return "1";
+	case VF::Solver::MEMO_2: return "2";
+	case VF::Solver::MEMO_3: return "3";
+	default: return "V";
+	}
+}
+
+static void NotifySolved()
+{
+	if (solvedEventType == (Uint32)-1)
+		return;
+
+	SDL_Event event {};
+	event.type = solvedEventType;
+	SDL_PushEvent(&event);
+}
 
 
 static void OnImGuiRender(ImVec4& clear_color, ImGuiIO& io)
@@ -61,7 +91,7 @@ static void OnImGuiRender(ImVec4& clear_color, ImGuiIO& io)
 
 				if (ImGui::Button("Create field"))
 				{
-					p_Solver = new VF::Solver(columns, rows);
+					p_Solver = new VF::SolverThread(rows, columns, NotifySolved);
 					uPoint = new unsigned int[columns] {};
 					vPoint = new unsigned int[rows] {};
 					uVolt = new unsigned int[columns] {};
@@ -87,6 +117,16 @@ static void OnImGuiRender(ImVec4& clear_color, ImGuiIO& io)
 
 				if (p_Solver)
 				{
+					//	The snapshot stays the same for the whole frame, even if a button queues a new action.
+					const VF::SolverThread::Snapshot& board = p_Solver->GetSnapshot();
+					bool isValidBoard = board.isValid;
+
+					ImGui::SameLine();
+					if (p_Solver->IsSolving())
+						ImGui::TextDisabled("Solving...");
+					else if (!isValidBoard)
+						ImGui::TextDisabled("Invalid hints");
+
 					if (ImGui::BeginTable("##tableSolver", 2, ImGuiTableFlags_NoHostExtendX | ImGuiTableFlags_BordersOuter))
 					{
 						ImGui::TableNextRow();
@@ -102,43 +142,35 @@ static void OnImGuiRender(ImVec4& clear_color, ImGuiIO& io)
 								{
 									ImGui::TableSetColumnIndex(u);
 
-									int memo = p_Solver->GetMemo(u, v);
+									unsigned char memo = board.memos[u * rows + v];
+									bool isUserConfirmed = board.userConf[u * rows + v];
+									ImGui::PushID((int)(u * rows + v));
 
-									auto VFButton = [memo, u, v](VF::Solver::MEMO_TYPE _type) mutable
+									auto VFButton = [memo, isUserConfirmed, isValidBoard, u, v](VF::Solver::MEMO_TYPE _type)
 									{
 										bool isPressed = false;
 
 										constexpr ImVec2 buttonSize = { 50, 50 };
-										std::string buttonName = "";
-										switch (_type)
-										{
-										case VF::Solver::MEMO_1:
-											buttonName = std::format("1##{},{}", u, v); break;
-										case VF::Solver::MEMO_2:
-											buttonName = std::format("2##{},{}", u, v); break;
-										case VF::Solver::MEMO_3:
-											buttonName = std::format("3##{},{}", u, v); break;
-										case VF::Solver::MEMO_VOLT:
-											buttonName = std::format("V##{},{}", u, v); break;
-										}
+										const char* buttonName = GetMemoLabel(_type);
 
 										if (memo & _type)
 										{
-											ImGui::PushStyleColor(ImGuiCol_Button, p_Solver->IsMemoUserConfirmed(u, v) ? ImVec4(0.0f, 0.75f, 0.0f, 1.0f) : ImVec4(0.0f, 0.25f, 0.5f, 1.0f));
-											isPressed = ImGui::Button(buttonName.c_str(), buttonSize);
+											ImGui::PushStyleColor(ImGuiCol_Button, isUserConfirmed ? ImVec4(0.0f, 0.75f, 0.0f, 1.0f) : ImVec4(0.0f, 0.25f, 0.5f, 1.0f));
+											isPressed = ImGui::Button(buttonName, buttonSize);
 											ImGui::PopStyleColor();
 										}
 										else
 										{
-											ImGui::InvisibleButton(buttonName.c_str(), buttonSize);
+											ImGui::InvisibleButton(buttonName, buttonSize);
 										}
 
+										//	The change shows up once the solver thread has published the new board.
 										if (isValidBoard && isPressed)
 										{
-											if (p_Solver->IsMemoUserConfirmed(u, v))
-												memo = p_Solver->UnsetMemo(u, v);
+											if (isUserConfirmed)
+												p_Solver->UnsetMemo(u, v);
 											else
-												memo = p_Solver->SetMemo(u, v, _type);
+												p_Solver->SetMemo(u, v, _type);
 										}
 
 										return isPressed;
@@ -153,6 +185,8 @@ static void OnImGuiRender(ImVec4& clear_color, ImGuiIO& io)
 
 									ImGui::SameLine();
 									VFButton(VF::Solver::MEMO_VOLT);
+
+									ImGui::PopID();
 								}
 							}
 
@@ -172,21 +206,23 @@ static void OnImGuiRender(ImVec4& clear_color, ImGuiIO& io)
 								ImGui::TableSetColumnIndex(0);
 
 								ImGui::PushItemWidth(50);
+								ImGui::PushID((int)v);
 
-								if (ImGui::InputInt(std::format("##p{}", v).c_str(), (int*)(vPoint + v), 0, 0))
+								if (ImGui::InputInt("##p", (int*)(vPoint + v), 0, 0))
 									isHintsChanged = true;
 								if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
 								{
 									ImGui::SetTooltip("Points");
 								}
 
-								if (ImGui::InputInt(std::format("##v{}", v).c_str(), (int*)(vVolt + v), 0, 0))
+								if (ImGui::InputInt("##v", (int*)(vVolt + v), 0, 0))
 									isHintsChanged = true;
 								if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
 								{
 									ImGui::SetTooltip("Volts");
 								}
 
+								ImGui::PopID();
 								ImGui::PopItemWidth();
 							}
 
@@ -206,21 +242,23 @@ static void OnImGuiRender(ImVec4& clear_color, ImGuiIO& io)
 								ImGui::TableSetColumnIndex(u);
 
 								ImGui::PushItemWidth(50);
+								ImGui::PushID((int)u);
 
-								if (ImGui::InputInt(std::format("##p{}", u).c_str(), (int*)(uPoint + u), 0, 0))
+								if (ImGui::InputInt("##p", (int*)(uPoint + u), 0, 0))
 									isHintsChanged = true;
 								if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
 								{
 									ImGui::SetTooltip("Points");
 								}
 
-								if (ImGui::InputInt(std::format("##v{}", u).c_str(), (int*)(uVolt + u), 0, 0))
+								if (ImGui::InputInt("##v", (int*)(uVolt + u), 0, 0))
 									isHintsChanged = true;
 								if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
 								{
 									ImGui::SetTooltip("Volts");
 								}
 
+								ImGui::PopID();
 								ImGui::PopItemWidth();
 							}
 
@@ -229,7 +267,7 @@ static void OnImGuiRender(ImVec4& clear_color, ImGuiIO& io)
 
 						if (isHintsChanged)
 						{
-							isValidBoard = p_Solver->SetHints(uPoint, vPoint, uVolt, vVolt);
+							p_Solver->SetHints(uPoint, vPoint, uVolt, vVolt);
 						}
 
 						ImGui::EndTable();
@@ -258,6 +296,7 @@ int main(int, char**)
 		printf("Error: %s\n", SDL_GetError());
 		return -1;
 	}
+	solvedEventType = SDL_RegisterEvents(1);
 
 	// From 2.0.18: Enable native IME.
 #ifdef SDL_HINT_IME_SHOW_UI
@@ -348,20 +387,38 @@ int main(int, char**)
 		// - When io.WantCaptureMouse is true, do not dispatch mouse input data to your main application, or clear/overwrite your copy of the mouse data.
 		// - When io.WantCaptureKeyboard is true, do not dispatch keyboard input data to your main application, or clear/overwrite your copy of the keyboard data.
 		// Generally you may always pass all inputs to dear imgui, and hide them from your application based on those two flags.
-		SDL_Event event;
-		while (SDL_PollEvent(&event))
+		// Nothing changes between events, so once the last event has settled, block until the next one instead of redrawing at vsync.
+		// While a text field is active, wake up twice a second so its cursor keeps blinking.
+		auto handleEvent = [&done, window](const SDL_Event& event)
 		{
 			ImGui_ImplSDL2_ProcessEvent(&event);
 			if (event.type == SDL_QUIT)
 				done = true;
 			if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_CLOSE && event.window.windowID == SDL_GetWindowID(window))
 				done = true;
+			framesToDraw = FRAMES_AFTER_EVENT;
+		};
+
+		SDL_Event event;
+		if (framesToDraw <= 0)
+		{
+			if (io.WantTextInput ? SDL_WaitEventTimeout(&event, 500) : SDL_WaitEvent(&event))
+				handleEvent(event);
+			else
+				framesToDraw = 1;
 		}
+		while (SDL_PollEvent(&event))
+			handleEvent(event);
+
+		if (done)
+			break;
+
 		if (SDL_GetWindowFlags(window) & SDL_WINDOW_MINIMIZED)
 		{
-			SDL_Delay(10);
+			framesToDraw = 0;
 			continue;
 		}
+		framesToDraw--;
 
 		// Start the Dear ImGui frame
 		ImGui_ImplSDLRenderer2_NewFrame();
@@ -380,6 +437,13 @@ int main(int, char**)
 	}
 
 	// Cleanup
+	// Stop the solver thread first, it may still push events.
+	delete p_Solver;
+	delete[] uPoint;
+	delete[] vPoint;
+	delete[] uVolt;
+	delete[] vVolt;
+
 	ImGui_ImplSDLRenderer2_Shutdown();
 	ImGui_ImplSDL2_Shutdown();
 	ImGui::DestroyContext();